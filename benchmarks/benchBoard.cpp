@@ -0,0 +1,171 @@
+// clang-format off
+#include "../src/utils.hpp"
+#include "../src/board.hpp"
+#include "../src/bench.hpp"
+#include "micro_bench.hpp"
+#include <fstream>
+
+// Standard perft positions
+const std::array<std::string, 6> PERFT_FENS = {
+    START_FEN,
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"
+};
+
+// Reversible moves played from each root position, so that positions have history
+constexpr int SHUFFLE_PLIES = 8;
+
+// Usage: benchBoard [fens file]
+// By default, the positions are BENCH_FENS and PERFT_FENS
+int main(int argc, char* argv[])
+{
+    printIsa();
+
+    std::vector<std::string> fens = { };
+
+    if (argc > 1) {
+        std::ifstream file(argv[1]);
+        std::string line;
+
+        while (std::getline(file, line))
+        {
+            trim(line);
+            if (line != "") fens.push_back(line);
+        }
+    }
+    else {
+        fens.insert(fens.end(), BENCH_FENS.begin(), BENCH_FENS.end());
+        fens.insert(fens.end(), PERFT_FENS.begin(), PERFT_FENS.end());
+    }
+
+    // Each root position and the positions after playing some reversible moves from it
+
+    std::vector<Board> boards = { };
+
+    for (const std::string &fen : fens)
+    {
+        Board board = Board(fen);
+        boards.push_back(board);
+
+        for (int ply = 0; ply < SHUFFLE_PLIES; ply++)
+        {
+            ArrayVec<Move, 256> moves;
+            board.pseudolegalMoves(moves, MoveGenType::QUIETS, false);
+
+            std::vector<Move> reversibleMoves = { };
+
+            for (const Move move : moves)
+                if (move.pieceType() != PieceType::PAWN
+                && move.flag() != Move::CASTLING_FLAG
+                && board.isPseudolegalLegal(move))
+                    reversibleMoves.push_back(move);
+
+            if (reversibleMoves.empty()) break;
+
+            board.makeMove(reversibleMoves[board.zobristHash() % reversibleMoves.size()]);
+            boards.push_back(board);
+        }
+    }
+
+    // Every pseudolegal move of every position, as [board index, move]
+
+    std::vector<std::pair<size_t, Move>> boardsMoves = { };
+    std::vector<std::pair<size_t, Move>> boardsLegalMoves = { };
+
+    for (size_t i = 0; i < boards.size(); i++)
+    {
+        ArrayVec<Move, 256> moves;
+        boards[i].pseudolegalMoves(moves, MoveGenType::ALL);
+
+        for (const Move move : moves)
+        {
+            boardsMoves.push_back({ i, move });
+
+            if (boards[i].isPseudolegalLegal(move))
+                boardsLegalMoves.push_back({ i, move });
+        }
+    }
+
+    std::cout << boards.size() << " positions "
+              << boardsMoves.size() << " pseudolegal moves "
+              << boardsLegalMoves.size() << " legal moves"
+              << std::endl;
+
+    // Move generation
+
+    const std::array<std::pair<std::string, MoveGenType>, 3> moveGenTypes = {
+        std::pair { "pseudolegalMoves ALL",     MoveGenType::ALL     },
+        std::pair { "pseudolegalMoves NOISIES", MoveGenType::NOISIES },
+        std::pair { "pseudolegalMoves QUIETS",  MoveGenType::QUIETS  }
+    };
+
+    for (const auto &[name, moveGenType] : moveGenTypes)
+        microBench(name, [&](const u64 i) -> u64
+        {
+            ArrayVec<Move, 256> moves;
+            boards[i % boards.size()].pseudolegalMoves(moves, moveGenType);
+            benchSink(moves.size());
+            return 0;
+        });
+
+    // Make/unmake
+
+    microBench("makeMove + undoMove", [&](const u64 i) -> u64
+    {
+        const auto [boardIdx, move] = boardsLegalMoves[i % boardsLegalMoves.size()];
+        Board &board = boards[boardIdx];
+
+        board.makeMove(move);
+        benchSink(board.zobristHash());
+        board.undoMove();
+
+        return 0;
+    });
+
+    // Move legality
+
+    // TT moves and killers come from other positions, so try moves of the next position
+    microBench("isPseudolegal", [&](const u64 i) -> u64
+    {
+        const auto [boardIdx, move] = boardsMoves[i % boardsMoves.size()];
+        benchSink(boards[(boardIdx + 1) % boards.size()].isPseudolegal(move));
+        return 0;
+    });
+
+    microBench("isPseudolegalLegal", [&](const u64 i) -> u64
+    {
+        const auto [boardIdx, move] = boardsMoves[i % boardsMoves.size()];
+        benchSink(boards[boardIdx].isPseudolegalLegal(move));
+        return 0;
+    });
+
+    // SEE
+
+    microBench("SEE", [&](const u64 i) -> u64
+    {
+        const auto [boardIdx, move] = boardsMoves[i % boardsMoves.size()];
+        benchSink(boards[boardIdx].SEE(move));
+        return 0;
+    });
+
+    // Cuckoo upcoming repetition detection
+
+    microBench("hasUpcomingRepetition", [&](const u64 i) -> u64
+    {
+        benchSink(boards[i % boards.size()].hasUpcomingRepetition(1));
+        return 0;
+    });
+
+    // Attackers of a square
+
+    microBench("attackers", [&](const u64 i) -> u64
+    {
+        benchSink(boards[(i / 64) % boards.size()].attackers(i % 64));
+        return 0;
+    });
+
+    return 0;
+}
@@ -0,0 +1,163 @@
+// clang-format off
+#include "../src/utils.hpp"
+#include "../src/board.hpp"
+#include "../src/nnue.hpp"
+#include "../src/bench.hpp"
+#include "micro_bench.hpp"
+
+constexpr u64 ACC_ROW_BYTES = nnue::HIDDEN_LAYER_SIZE * sizeof(i16);
+
+enum class UpdateType {
+    QUIET, CAPTURE, CASTLING, BUCKET_CHANGE
+};
+
+// Board after a move and the accumulators before it
+struct UpdateCase {
+    public:
+    Board board;
+    BothAccumulators prevAccs;
+};
+
+// How many features updateFinnyEntryAndAccumulator() will add or remove
+inline u64 finnyEntryDiffs(const FinnyTable &finnyTable, const BothAccumulators &accs, const Color accColor, const Board &board)
+{
+    const FinnyTableEntry &finnyEntry = finnyTable
+        [(int)accColor][accs.mMirrorHorizontally[(int)accColor]][accs.mInputBucket[(int)accColor]];
+
+    u64 diffs = 0;
+
+    for (const Color pieceColor : {Color::WHITE, Color::BLACK})
+        for (int pt = PAWN; pt <= KING; pt++)
+        {
+            const u64 entryBb = finnyEntry.colorBitboards[(int)pieceColor] & finnyEntry.piecesBitboards[pt];
+            diffs += std::popcount(board.getBb(pieceColor, (PieceType)pt) ^ entryBb);
+        }
+
+    return diffs;
+}
+
+int main()
+{
+    printIsa();
+
+    std::vector<Board> boards = { };
+
+    for (const std::string fen : BENCH_FENS)
+        boards.push_back(Board(fen));
+
+    // Legal moves of every position grouped by how they update the accumulators
+
+    FinnyTable finnyTable;
+    nnue::resetFinnyTable(finnyTable);
+
+    std::array<std::vector<UpdateCase>, 4> updateCases = { }; // [UpdateType]
+
+    for (Board board : boards)
+    {
+        BothAccumulators prevAccs = BothAccumulators(board);
+
+        ArrayVec<Move, 256> moves;
+        board.pseudolegalMoves(moves, MoveGenType::ALL);
+
+        for (const Move move : moves)
+        {
+            if (!board.isPseudolegalLegal(move)) continue;
+
+            board.makeMove(move);
+
+            BothAccumulators accs = BothAccumulators();
+            accs.update(&prevAccs, board, finnyTable);
+
+            const UpdateType updateType
+                = accs.mMirrorHorizontally != prevAccs.mMirrorHorizontally || accs.mInputBucket != prevAccs.mInputBucket
+                ? UpdateType::BUCKET_CHANGE
+                : move.flag() == Move::CASTLING_FLAG
+                ? UpdateType::CASTLING
+                : board.captured() != PieceType::NONE
+                ? UpdateType::CAPTURE
+                : UpdateType::QUIET;
+
+            updateCases[(int)updateType].push_back({ board, prevAccs });
+
+            board.undoMove();
+        }
+    }
+
+    // Full refresh
+
+    microBench("BothAccumulators(board)", [&](const u64 i) -> u64
+    {
+        const Board &board = boards[i % boards.size()];
+        const BothAccumulators accs = BothAccumulators(board);
+        benchSink(accs.mAccumulators[0][i % nnue::HIDDEN_LAYER_SIZE]);
+
+        return (2 + 2 * std::popcount(board.occupancy())) * ACC_ROW_BYTES;
+    });
+
+    // Incremental updates
+
+    const std::array<std::string, 4> updateTypeNames = {
+        "update() quiet", "update() capture", "update() castling", "update() king bucket change"
+    };
+
+    const std::array<u64, 4> updateTypeRows = { 2, 3, 4, 0 }; // weight rows per accumulator, 0 = varies
+
+    for (int updateType = 0; updateType < 4; updateType++)
+    {
+        std::vector<UpdateCase> &cases = updateCases[updateType];
+
+        if (cases.empty()) {
+            std::cout << updateTypeNames[updateType] << ": no positions" << std::endl;
+            continue;
+        }
+
+        BothAccumulators accs = BothAccumulators();
+
+        microBench(updateTypeNames[updateType], [&](const u64 i) -> u64
+        {
+            UpdateCase &updateCase = cases[i % cases.size()];
+
+            accs.mUpdated = false;
+            accs.update(&updateCase.prevAccs, updateCase.board, finnyTable);
+            benchSink(accs.mAccumulators[0][i % nnue::HIDDEN_LAYER_SIZE]);
+
+            return updateTypeRows[updateType] * 2 * ACC_ROW_BYTES;
+        });
+    }
+
+    // Finny table refresh
+
+    nnue::resetFinnyTable(finnyTable);
+
+    std::vector<BothAccumulators> boardsAccs = { };
+
+    for (const Board &board : boards)
+        boardsAccs.push_back(BothAccumulators(board));
+
+    microBench("updateFinnyEntryAndAccumulator", [&](const u64 i) -> u64
+    {
+        const size_t boardIdx = (i / 2) % boards.size();
+        const Color accColor = i % 2 == 0 ? Color::WHITE : Color::BLACK;
+
+        BothAccumulators &accs = boardsAccs[boardIdx];
+        const u64 diffs = finnyEntryDiffs(finnyTable, accs, accColor, boards[boardIdx]);
+
+        accs.updateFinnyEntryAndAccumulator(finnyTable, accColor, boards[boardIdx]);
+        benchSink(accs.mAccumulators[(int)accColor][i % nnue::HIDDEN_LAYER_SIZE]);
+
+        return (diffs + 1) * ACC_ROW_BYTES;
+    });
+
+    // Output layer
+
+    microBench("nnue::evaluate", [&](const u64 i) -> u64
+    {
+        const size_t boardIdx = i % boards.size();
+        benchSink(nnue::evaluate(&boardsAccs[boardIdx], boards[boardIdx].sideToMove()));
+
+        // Both accumulators and both halves of output weights
+        return 4 * ACC_ROW_BYTES;
+    });
+
+    return 0;
+}
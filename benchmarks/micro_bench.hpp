@@ -0,0 +1,57 @@
+// clang-format off
+
+#pragma once
+
+#include "../src/utils.hpp"
+#include <iomanip>
+
+// Results are accumulated here so that the compiler can't remove the benchmarked work
+inline volatile u64 gBenchSink = 0;
+
+// Plain load and store, since compound assignment to a volatile is deprecated
+inline void benchSink(const u64 value) { gBenchSink = gBenchSink + value; }
+
+constexpr u64 MICRO_BENCH_MIN_NANOSECONDS = 500'000'000;
+
+inline void printIsa()
+{
+    #if defined(__AVX512F__) && defined(__AVX512BW__)
+        std::cout << "ISA avx512" << std::endl;
+    #elif defined(__AVX2__)
+        std::cout << "ISA avx2" << std::endl;
+    #else
+        std::cout << "ISA generic" << std::endl;
+    #endif
+}
+
+// Calls func(i) for i = 0, 1, 2... for at least MICRO_BENCH_MIN_NANOSECONDS
+// func returns how many bytes of memory (e.g. net weights) that call read, or 0 if unknown
+// Prints ns/op, Mops/s and GB/s
+template <typename Func>
+inline void microBench(const std::string &name, Func func)
+{
+    constexpr u64 BATCH_SIZE = 1024;
+
+    u64 ops = 0, bytes = 0, nanoseconds = 0;
+
+    const std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+
+    while (nanoseconds < MICRO_BENCH_MIN_NANOSECONDS)
+    {
+        for (u64 i = 0; i < BATCH_SIZE; i++)
+            bytes += func(ops + i);
+
+        ops += BATCH_SIZE;
+        nanoseconds = (std::chrono::steady_clock::now() - start) / std::chrono::nanoseconds(1);
+    }
+
+    std::cout << std::left << std::setw(32) << name << std::right
+              << std::fixed << std::setprecision(2)
+              << std::setw(12) << (double)nanoseconds / (double)ops << " ns/op"
+              << std::setw(12) << (double)ops * 1000.0 / (double)nanoseconds << " Mops/s";
+
+    if (bytes > 0)
+        std::cout << std::setw(10) << (double)bytes / (double)nanoseconds << " GB/s";
+
+    std::cout << std::defaultfloat << std::endl;
+}
@@ -0,0 +1,214 @@
+// clang-format off
+
+#include "starzix.hpp"
+#include "starzix.h"
+#include "../src/utils.hpp"
+#include "../src/board.hpp"
+#include "../src/search.hpp"
+#include "../src/time_manager.hpp"
+#include <cstring>
+
+namespace starzix {
+
+struct Engine::Impl {
+    public:
+    Searcher searcher = Searcher();
+};
+
+inline int mateMoves(const i32 score)
+{
+    if (abs(score) < MIN_MATE_SCORE) return 0;
+
+    const i32 movesTillMate = round((INF - abs(score)) / 2.0);
+    return score > 0 ? movesTillMate : -movesTillMate;
+}
+
+Engine::Engine() : mImpl(std::make_unique<Impl>()) { }
+
+Engine::~Engine() = default;
+
+void Engine::newGame() { mImpl->searcher.ucinewgame(); }
+
+int Engine::setThreads(const int numThreads) {
+    return mImpl->searcher.setThreads(std::max(numThreads, 1));
+}
+
+void Engine::setHashMB(const int64_t hashMB) { resizeTT(mImpl->searcher.mTT, hashMB); }
+
+bool Engine::setPosition(const std::string &fen, const std::vector<std::string> &uciMoves)
+{
+    if (fen != "startpos" && !isValidFen(fen))
+        return false;
+
+    Board board = fen == "startpos" ? START_BOARD : Board(fen);
+
+    for (const std::string &uciMove : uciMoves)
+    {
+        ArrayVec<Move, 256> moves;
+        board.pseudolegalMoves(moves, MoveGenType::ALL);
+
+        Move legalMove = MOVE_NONE;
+
+        for (const Move move : moves)
+            if (move.toUci() == uciMove && board.isPseudolegalLegal(move))
+                legalMove = move;
+
+        if (legalMove == MOVE_NONE) return false;
+
+        board.makeMove(legalMove);
+    }
+
+    mImpl->searcher.board() = board;
+    return true;
+}
+
+std::string Engine::fen() const { return mImpl->searcher.board().fen(); }
+
+SearchResult Engine::search(
+    const SearchLimits &limits,
+    const std::function<void(const SearchInfo&)> &onIteration)
+{
+    const std::chrono::time_point<std::chrono::steady_clock> startTime = std::chrono::steady_clock::now();
+
+    Searcher &searcher = mImpl->searcher;
+
+    i64 milliseconds = std::numeric_limits<i64>::max();
+    const bool isMoveTime = limits.moveTimeMs > 0;
+
+    if (isMoveTime)
+        milliseconds = limits.moveTimeMs;
+    else if (limits.timeMs > 0)
+        milliseconds = limits.timeMs;
+
+    const auto [hardMs, softMs] = searchTimeLimits(
+        milliseconds,
+        std::max<i64>(limits.incrementMs, 0),
+        std::max(limits.movesToGo, 0),
+        isMoveTime,
+        std::max<i64>(limits.moveOverheadMs, 0)
+    );
+
+    if (onIteration)
+        searcher.setIterationCallback([&](const ::SearchInfo &info)
+        {
+            SearchInfo libInfo = SearchInfo();
+            libInfo.depth = info.depth;
+            libInfo.seldepth = info.seldepth;
+            libInfo.scoreCp = abs(info.score) < MIN_MATE_SCORE ? info.score : 0;
+            libInfo.mate = mateMoves(info.score);
+            libInfo.nodes = info.nodes;
+            libInfo.timeMs = info.milliseconds;
+
+            for (const Move move : info.pvLine)
+                libInfo.pv.push_back(move.toUci());
+
+            onIteration(libInfo);
+        });
+
+    const auto [bestMove, score] = searcher.search(
+        limits.depth > 0 ? limits.depth : MAX_DEPTH,
+        limits.nodes > 0 ? limits.nodes : std::numeric_limits<u64>::max(),
+        startTime,
+        hardMs,
+        softMs,
+        false
+    );
+
+    searcher.setIterationCallback(nullptr);
+
+    SearchResult result = SearchResult();
+    result.bestMove = bestMove != MOVE_NONE ? bestMove.toUci() : "";
+    result.scoreCp = abs(score) < MIN_MATE_SCORE ? score : 0;
+    result.mate = mateMoves(score);
+    result.nodes = searcher.totalNodes();
+
+    return result;
+}
+
+} // namespace starzix
+
+// C ABI
+
+struct starzix_engine {
+    public:
+    starzix::Engine engine;
+};
+
+extern "C" {
+
+starzix_engine* starzix_create(void) { return new starzix_engine(); }
+
+void starzix_destroy(starzix_engine* engine) { delete engine; }
+
+void starzix_new_game(starzix_engine* engine) { engine->engine.newGame(); }
+
+int starzix_set_threads(starzix_engine* engine, int num_threads) {
+    return engine->engine.setThreads(num_threads);
+}
+
+void starzix_set_hash(starzix_engine* engine, int64_t hash_mb) { engine->engine.setHashMB(hash_mb); }
+
+int starzix_set_position(starzix_engine* engine, const char* fen, const char* const* moves, size_t num_moves)
+{
+    if (fen == nullptr) return 0;
+
+    std::vector<std::string> uciMoves = { };
+
+    for (size_t i = 0; i < num_moves; i++)
+        uciMoves.push_back(moves[i]);
+
+    return engine->engine.setPosition(fen, uciMoves);
+}
+
+int starzix_search(
+    starzix_engine* engine,
+    const starzix_limits* limits,
+    starzix_info_callback callback,
+    void* user_data,
+    char best_move[6],
+    int* score_cp,
+    int* mate)
+{
+    starzix::SearchLimits libLimits = starzix::SearchLimits();
+
+    if (limits != nullptr) {
+        libLimits.depth          = limits->depth;
+        libLimits.nodes          = limits->nodes;
+        libLimits.moveTimeMs     = limits->move_time_ms;
+        libLimits.timeMs         = limits->time_ms;
+        libLimits.incrementMs    = limits->increment_ms;
+        libLimits.movesToGo      = limits->moves_to_go;
+        libLimits.moveOverheadMs = limits->move_overhead_ms;
+    }
+
+    std::function<void(const starzix::SearchInfo&)> onIteration = nullptr;
+
+    if (callback != nullptr)
+        onIteration = [&](const starzix::SearchInfo &info)
+        {
+            std::string pv = "";
+
+            for (const std::string &move : info.pv)
+                pv += (pv == "" ? "" : " ") + move;
+
+            const starzix_info cInfo = {
+                info.depth, info.seldepth, info.scoreCp, info.mate, info.nodes, info.timeMs, pv.c_str()
+            };
+
+            callback(&cInfo, user_data);
+        };
+
+    const starzix::SearchResult result = engine->engine.search(libLimits, onIteration);
+
+    if (best_move != nullptr) {
+        std::memset(best_move, 0, 6);
+        std::memcpy(best_move, result.bestMove.c_str(), std::min<size_t>(result.bestMove.size(), 5));
+    }
+
+    if (score_cp != nullptr) *score_cp = result.scoreCp;
+    if (mate != nullptr) *mate = result.mate;
+
+    return result.bestMove != "";
+}
+
+} // extern "C"
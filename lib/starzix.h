@@ -0,0 +1,73 @@
+/* clang-format off */
+
+#pragma once
+
+/* Starzix C library API (libstarzix.a / libstarzix.so, built with "make lib") */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct starzix_engine starzix_engine;
+
+/* 0 means no limit (so move_overhead_ms must be set explicitly, e.g. 10)
+   With time_ms (remaining clock time of side to move), time is managed like "go wtime/btime" */
+typedef struct starzix_limits {
+    int depth;
+    uint64_t nodes;
+    int64_t move_time_ms;
+    int64_t time_ms;
+    int64_t increment_ms;
+    int moves_to_go;
+    int64_t move_overhead_ms;
+} starzix_limits;
+
+/* Sent after each completed iteration
+   pv (space separated UCI moves) is only valid during the callback */
+typedef struct starzix_info {
+    int depth;
+    int seldepth;
+    int score_cp; /* only meaningful if mate == 0 */
+    int mate;     /* moves till mate, negative if getting mated, 0 if not a mate score */
+    uint64_t nodes;
+    uint64_t time_ms;
+    const char* pv;
+} starzix_info;
+
+typedef void (*starzix_info_callback)(const starzix_info* info, void* user_data);
+
+starzix_engine* starzix_create(void);
+
+void starzix_destroy(starzix_engine* engine);
+
+/* Clears TT and histories and sets startpos */
+void starzix_new_game(starzix_engine* engine);
+
+/* Returns the number of threads set (clamped to [1, 256]) */
+int starzix_set_threads(starzix_engine* engine, int num_threads);
+
+void starzix_set_hash(starzix_engine* engine, int64_t hash_mb);
+
+/* fen can be "startpos", moves can be NULL if num_moves is 0
+   Returns 0, without changing the position, if the FEN or a move is invalid or illegal, else 1 */
+int starzix_set_position(starzix_engine* engine, const char* fen, const char* const* moves, size_t num_moves);
+
+/* Blocks until the search finishes, callback can be NULL
+   Writes the best move (UCI, null terminated, empty if no legal moves) to best_move,
+   and the score to score_cp and mate (both can be NULL)
+   Returns 1 if there is a best move, else 0 */
+int starzix_search(
+    starzix_engine* engine,
+    const starzix_limits* limits,
+    starzix_info_callback callback,
+    void* user_data,
+    char best_move[6],
+    int* score_cp,
+    int* mate);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
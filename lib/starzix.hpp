@@ -0,0 +1,84 @@
+// clang-format off
+
+#pragma once
+
+// Starzix C++ library API (libstarzix.a / libstarzix.so, built with "make lib")
+// Only depends on the standard library, the engine itself is in the library
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace starzix {
+
+// 0 means no limit
+// With timeMs (remaining clock time of side to move), time is managed like "go wtime/btime"
+struct SearchLimits {
+    public:
+    int depth = 0;
+    uint64_t nodes = 0;
+    int64_t moveTimeMs = 0;
+    int64_t timeMs = 0;
+    int64_t incrementMs = 0;
+    int movesToGo = 0;
+    int64_t moveOverheadMs = 10;
+};
+
+// Sent after each completed iteration
+struct SearchInfo {
+    public:
+    int depth = 0;
+    int seldepth = 0;
+    int scoreCp = 0; // only meaningful if mate == 0
+    int mate = 0;    // moves till mate, negative if getting mated, 0 if not a mate score
+    uint64_t nodes = 0;
+    uint64_t timeMs = 0;
+    std::vector<std::string> pv = { }; // UCI moves
+};
+
+struct SearchResult {
+    public:
+    std::string bestMove = ""; // UCI move, empty if no legal moves
+    int scoreCp = 0;
+    int mate = 0;
+    uint64_t nodes = 0;
+};
+
+class Engine {
+    private:
+
+    struct Impl;
+    std::unique_ptr<Impl> mImpl;
+
+    public:
+
+    Engine();
+    ~Engine();
+
+    Engine(const Engine&) = delete;
+    Engine& operator=(const Engine&) = delete;
+
+    // Clears TT and histories and sets startpos
+    void newGame();
+
+    // Returns the number of threads set (clamped to [1, 256])
+    int setThreads(const int numThreads);
+
+    void setHashMB(const int64_t hashMB);
+
+    // fen can be "startpos"
+    // Returns false, without changing the position, if the FEN or a move is invalid or illegal
+    bool setPosition(const std::string &fen, const std::vector<std::string> &uciMoves = { });
+
+    std::string fen() const;
+
+    // Blocks until the search finishes
+    // onIteration is called from the search's main thread
+    SearchResult search(
+        const SearchLimits &limits,
+        const std::function<void(const SearchInfo&)> &onIteration = nullptr);
+};
+
+} // namespace starzix
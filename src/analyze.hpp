@@ -0,0 +1,133 @@
+// clang-format off
+
+#pragma once
+
+#include "utils.hpp"
+#include "board.hpp"
+#include "search.hpp"
+#include "packed_board_io.hpp"
+#include <fstream>
+#include <memory>
+
+// Batch analysis of independent positions with Searcher::analyze()
+
+inline std::string analysisJson(const AnalysisResult &result)
+{
+    const Board board = Board(result.position);
+
+    std::string json = "{\"index\": " + std::to_string(result.index)
+                     + ", \"fen\": \"" + board.fen() + "\""
+                     + ", \"depth\": " + std::to_string(result.depth);
+
+    if (abs(result.score) < MIN_MATE_SCORE)
+        json += ", \"cp\": " + std::to_string(result.score);
+    else {
+        const i32 movesTillMate = round((INF - abs(result.score)) / 2.0);
+        json += ", \"mate\": " + std::to_string(result.score > 0 ? movesTillMate : -movesTillMate);
+    }
+
+    json += ", \"bestmove\": \"";
+    json += result.pvLine.size() > 0 ? result.pvLine[0].toUci() : "0000";
+    json += "\", \"pv\": \"";
+
+    for (size_t i = 0; i < result.pvLine.size(); i++)
+        json += (i > 0 ? " " : "") + result.pvLine[i].toUci();
+
+    json += "\", \"nodes\": " + std::to_string(result.nodes)
+          + ", \"time\": "    + std::to_string(result.milliseconds)
+          + "}";
+
+    return json;
+}
+
+// Analyzes the positions of inFile (.bin packed positions or FEN lines),
+// or FEN lines from stdin until "end" or EOF if inFile is empty,
+// printing a JSON line per position as soon as its search finishes (so not in input order, see "index")
+inline void analyze(Searcher &searcher, const i32 maxDepth, const u64 maxNodes, const std::string &inFile)
+{
+    std::ifstream fenFile;
+    std::unique_ptr<PackedBoardReader> packedIn = nullptr;
+
+    if (inFile != "" && isPackedFile(inFile))
+    {
+        packedIn = std::make_unique<PackedBoardReader>(inFile);
+
+        if (!packedIn->isOpen()) {
+            std::cout << "info string Failed to open " << inFile << std::endl;
+            return;
+        }
+    }
+    else if (inFile != "")
+    {
+        fenFile.open(inFile);
+
+        if (!fenFile.is_open()) {
+            std::cout << "info string Failed to open " << inFile << std::endl;
+            return;
+        }
+    }
+
+    std::istream &fenIn = inFile != "" ? fenFile : std::cin;
+
+    // Once there are no more positions, don't read any more lines (the next ones are UCI commands)
+    bool inputEnded = false;
+
+    u64 linesRead = 0, invalidLines = 0;
+
+    const auto nextPosition = [&](PackedBoard &position) -> bool
+    {
+        if (packedIn) return packedIn->next(position);
+
+        std::string line;
+
+        while (!inputEnded && std::getline(fenIn, line))
+        {
+            linesRead++;
+
+            // Ignore anything after the fen, e.g. "<fen> | <score> | <result>"
+            line = line.substr(0, line.find('|'));
+            trim(line);
+
+            if (line == "end") break;
+
+            if (line == "") continue;
+
+            if (!isValidFen(line)) {
+                std::cout << "info string Skipping invalid FEN on line " << linesRead << ": " << line << std::endl;
+                invalidLines++;
+                continue;
+            }
+
+            position = Board(line).pack();
+            return true;
+        }
+
+        inputEnded = true;
+        return false;
+    };
+
+    u64 positions = 0, nodes = 0;
+
+    const auto onResult = [&](const AnalysisResult &result)
+    {
+        std::cout << analysisJson(result) << std::endl;
+
+        positions++;
+        nodes += result.nodes;
+    };
+
+    const std::chrono::time_point<std::chrono::steady_clock> startTime = std::chrono::steady_clock::now();
+
+    searcher.analyze(maxDepth, maxNodes, nextPosition, onResult);
+
+    const u64 ms = std::max<u64>(millisecondsElapsed(startTime), 1);
+
+    std::cout << "info string analyze positions " << positions
+              << " nodes "          << nodes
+              << " nps "            << nodes * 1000 / ms
+              << " positions/sec "  << (double)positions * 1000.0 / (double)ms
+              << " time "           << ms
+              << (packedIn ? " invalid records " : " invalid FEN lines ")
+              << (packedIn ? packedIn->invalidRecords() : invalidLines)
+              << std::endl;
+}
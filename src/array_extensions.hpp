@@ -4,6 +4,9 @@
 
 #include <array>
 #include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
 
 // MultiArray
 
@@ -85,3 +88,112 @@ struct ArrayVec
     }
 
 }; // struct ArrayVec
+
+// Arena
+// Per-thread bump allocator for lists with nested (LIFO) lifetimes, such as the move lists of search nodes
+
+template <typename T>
+struct Arena
+{
+    private:
+
+    std::vector<T> mVec;
+    std::size_t mSize = 0;
+
+    public:
+
+    inline Arena(const std::size_t capacity) {
+        mVec.resize(capacity);
+    }
+
+    constexpr std::size_t size() const { return mSize; }
+
+    constexpr T* data() { return mVec.data(); }
+
+    constexpr const T* data() const { return mVec.data(); }
+
+    // Capacity is checked in release builds too, since exceeding it means the arena was sized wrong
+    constexpr void push_back(const T elem)
+    {
+        if (mSize >= mVec.size()) [[unlikely]] {
+            std::fputs("Arena capacity exceeded\n", stderr);
+            std::abort();
+        }
+
+        mVec[mSize++] = elem;
+    }
+
+    constexpr void rewind(const std::size_t newSize)
+    {
+        assert(newSize <= mSize);
+        mSize = newSize;
+    }
+
+}; // struct Arena
+
+// ArenaVec
+// A list that starts at the top of an arena when created and gives its memory back when destroyed
+// It can only grow while it is the last allocation of the arena
+
+template <typename T>
+struct ArenaVec
+{
+    private:
+
+    Arena<T>* mArena;
+    std::size_t mStart;
+    std::size_t mSize = 0;
+
+    public:
+
+    constexpr ArenaVec(Arena<T> &arena) {
+        mArena = &arena;
+        mStart = arena.size();
+    }
+
+    ArenaVec(const ArenaVec&) = delete;
+    ArenaVec& operator=(const ArenaVec&) = delete;
+
+    constexpr ~ArenaVec() {
+        if (mStart < mArena->size())
+            mArena->rewind(mStart);
+    }
+
+    constexpr T operator[](const std::size_t i) const
+    {
+        assert(i < mSize);
+        return mArena->data()[mStart + i];
+    }
+
+    constexpr T& operator[](const std::size_t i)
+    {
+        assert(i < mSize);
+        return mArena->data()[mStart + i];
+    }
+
+    constexpr const T* begin() const {
+        return mArena->data() + mStart;
+    }
+
+    constexpr const T* end() const {
+        return mArena->data() + mStart + mSize;
+    }
+
+    constexpr std::size_t size() const {
+        return mSize;
+    }
+
+    constexpr void push_back(const T elem)
+    {
+        assert(mStart + mSize == mArena->size());
+        mArena->push_back(elem);
+        mSize++;
+    }
+
+    constexpr void swap(const std::size_t i, const std::size_t j)
+    {
+        assert(i < mSize && j < mSize);
+        std::swap((*this)[i], (*this)[j]);
+    }
+
+}; // struct ArenaVec
@@ -270,44 +270,73 @@ constexpr u64 ROOK_MAGICS[64] = {
     0x489a000810200402ULL, 0x1004400080a13ULL, 0x4000011008020084ULL, 0x26002114058042ULL,
 };
 
-// [square][index]
-constexpr MultiArray<u64, 64, 1ULL << 9ULL> BISHOP_ATTACKS_TABLE = []() consteval
+// Fancy magics: each square gets exactly 2^(64 - shift) slots
+// and all squares of both sliders share one packed table
+
+// [square]
+constexpr std::array<u64, 64> BISHOP_TABLE_OFFSETS = []() consteval
 {
-    MultiArray<u64, 64, 1ULL << 9ULL> bishopAttacksTable = { };
+    std::array<u64, 64> offsets;
+    u64 offset = 0;
 
     for (Square sq = 0; sq < 64; sq++)
     {
-        const u64 numBlockersArrangements = 1ULL << std::popcount(BISHOP_ATKS_EMPTY_BOARD_EXCLUDING_LAST_SQ_EACH_DIR[sq]);
+        offsets[sq] = offset;
+        offset += 1ULL << (64 - BISHOP_SHIFTS[sq]);
+    }
 
-        for (u64 n = 0; n < numBlockersArrangements; n++)
-        {
-            const u64 blockersArrangement = pdep(n, BISHOP_ATKS_EMPTY_BOARD_EXCLUDING_LAST_SQ_EACH_DIR[sq]);
-            const u64 index = (blockersArrangement * BISHOP_MAGICS[sq]) >> BISHOP_SHIFTS[sq];
-            bishopAttacksTable[sq][index] = bishopAttacksSlow(sq, blockersArrangement);
-        }
+    return offsets;
+}();
+
+// [square]
+constexpr std::array<u64, 64> ROOK_TABLE_OFFSETS = []() consteval
+{
+    std::array<u64, 64> offsets;
+    u64 offset = BISHOP_TABLE_OFFSETS[63] + (1ULL << (64 - BISHOP_SHIFTS[63]));
+
+    for (Square sq = 0; sq < 64; sq++)
+    {
+        offsets[sq] = offset;
+        offset += 1ULL << (64 - ROOK_SHIFTS[sq]);
     }
 
-    return bishopAttacksTable;
+    return offsets;
 }();
 
-// [square][index]
-constexpr MultiArray<u64, 64, 1ULL << 12ULL> ROOK_ATTACKS_TABLE = []() consteval
+// 5248 bishop entries + 102400 rook entries (~841 KB)
+constexpr u64 SLIDERS_TABLE_SIZE = ROOK_TABLE_OFFSETS[63] + (1ULL << (64 - ROOK_SHIFTS[63]));
+
+static_assert(SLIDERS_TABLE_SIZE == 5248 + 102400);
+
+// [offset + index]
+constexpr std::array<u64, SLIDERS_TABLE_SIZE> SLIDERS_ATTACKS_TABLE = []() consteval
 {
-    MultiArray<u64, 64, 1ULL << 12ULL> rookAttacksTable = { };
+    std::array<u64, SLIDERS_TABLE_SIZE> slidersAttacksTable = { };
 
     for (Square sq = 0; sq < 64; sq++)
     {
-        const u64 numBlockersArrangements = 1ULL << std::popcount(ROOK_ATKS_EMPTY_BOARD_EXCLUDING_LAST_SQ_EACH_DIR[sq]);
+        // Bishop
+        u64 numBlockersArrangements = 1ULL << std::popcount(BISHOP_ATKS_EMPTY_BOARD_EXCLUDING_LAST_SQ_EACH_DIR[sq]);
+
+        for (u64 n = 0; n < numBlockersArrangements; n++)
+        {
+            const u64 blockersArrangement = pdep(n, BISHOP_ATKS_EMPTY_BOARD_EXCLUDING_LAST_SQ_EACH_DIR[sq]);
+            const u64 index = (blockersArrangement * BISHOP_MAGICS[sq]) >> BISHOP_SHIFTS[sq];
+            slidersAttacksTable[BISHOP_TABLE_OFFSETS[sq] + index] = bishopAttacksSlow(sq, blockersArrangement);
+        }
+
+        // Rook
+        numBlockersArrangements = 1ULL << std::popcount(ROOK_ATKS_EMPTY_BOARD_EXCLUDING_LAST_SQ_EACH_DIR[sq]);
 
         for (u64 n = 0; n < numBlockersArrangements; n++)
         {
             const u64 blockersArrangement = pdep(n, ROOK_ATKS_EMPTY_BOARD_EXCLUDING_LAST_SQ_EACH_DIR[sq]);
             const u64 index = (blockersArrangement * ROOK_MAGICS[sq]) >> ROOK_SHIFTS[sq];
-            rookAttacksTable[sq][index] = rookAttacksSlow(sq, blockersArrangement);
+            slidersAttacksTable[ROOK_TABLE_OFFSETS[sq] + index] = rookAttacksSlow(sq, blockersArrangement);
         }
     }
 
-    return rookAttacksTable;
+    return slidersAttacksTable;
 }();
 
 } // namespace internal
@@ -325,7 +354,7 @@ constexpr u64 getBishopAttacks(const Square square, const u64 occupancy)
     using namespace internal;
     const u64 blockers = occupancy & BISHOP_ATKS_EMPTY_BOARD_EXCLUDING_LAST_SQ_EACH_DIR[square];
     const u64 index = (blockers * BISHOP_MAGICS[square]) >> BISHOP_SHIFTS[square];
-    return BISHOP_ATTACKS_TABLE[square][index];
+    return SLIDERS_ATTACKS_TABLE[BISHOP_TABLE_OFFSETS[square] + index];
 }
 
 constexpr u64 getRookAttacks(const Square square, const u64 occupancy)
@@ -333,7 +362,7 @@ constexpr u64 getRookAttacks(const Square square, const u64 occupancy)
     using namespace internal;
     const u64 blockers = occupancy & ROOK_ATKS_EMPTY_BOARD_EXCLUDING_LAST_SQ_EACH_DIR[square];
     const u64 index = (blockers * ROOK_MAGICS[square]) >> ROOK_SHIFTS[square];
-    return ROOK_ATTACKS_TABLE[square][index];
+    return SLIDERS_ATTACKS_TABLE[ROOK_TABLE_OFFSETS[square] + index];
 }
 
 constexpr u64 getQueenAttacks(const Square square, const u64 occupancy) {
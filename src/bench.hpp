@@ -5,6 +5,10 @@
 #include "utils.hpp"
 #include "board.hpp"
 #include "search.hpp"
+#include "perf_counters.hpp"
+#include <charconv>
+#include <fstream>
+#include <memory>
 
 constexpr std::array BENCH_FENS {
     "r3k2r/2pb1ppp/2pp1q2/p7/1nP1B3/1P2P3/P2N1PPP/R2QK2R w KQkq a6 0 14",
@@ -59,33 +63,355 @@ constexpr std::array BENCH_FENS {
     "2r2b2/5p2/5k2/p1r1pP2/P2pB3/1P3P2/K1P3R1/7R w - - 23 93"
 };
 
-inline void bench(const int depth = 14)
+struct BenchResult {
+    public:
+    std::string fen = "";
+    u64 nodes = 0;
+    u64 milliseconds = 0;
+    i32 depth = 0; // last completed depth
+    Move bestMove = MOVE_NONE;
+
+    constexpr u64 nps() const {
+        return nodes * 1000 / std::max<u64>(milliseconds, 1);
+    }
+};
+
+// Searches a position to a fixed depth from a new game state
+inline BenchResult benchPosition(Searcher &searcher, const std::string &fen, const int depth)
+{
+    searcher.ucinewgame();
+    searcher.board() = Board(fen);
+
+    const std::chrono::time_point<std::chrono::steady_clock> startTime = std::chrono::steady_clock::now();
+
+    const auto [bestMove, score] = searcher.search(
+        depth,
+        std::numeric_limits<u64>::max(),
+        startTime,
+        std::numeric_limits<u64>::max(),
+        std::numeric_limits<u64>::max(),
+        false
+    );
+
+    BenchResult result = BenchResult();
+    result.fen = fen;
+    result.nodes = searcher.totalNodes();
+    result.milliseconds = millisecondsElapsed(startTime);
+    result.depth = searcher.completedDepth();
+    result.bestMove = bestMove;
+    return result;
+}
+
+// "default" = BENCH_FENS, else one FEN per line
+inline std::vector<std::string> benchFens(const std::string &fensFile)
+{
+    if (fensFile == "default")
+        return std::vector<std::string>(BENCH_FENS.begin(), BENCH_FENS.end());
+
+    std::vector<std::string> fens = { };
+    std::ifstream file(fensFile);
+
+    if (!file.is_open())
+        std::cout << "info string Failed to open " << fensFile << std::endl;
+
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        trim(line);
+
+        if (line != "")
+            fens.push_back(line);
+    }
+
+    return fens;
+}
+
+// Hash of every position's nodes and best move
+// Changes if search behavior changes, independently of speed
+constexpr u64 benchChecksum(const std::vector<BenchResult> &results)
+{
+    u64 checksum = 0;
+
+    for (const BenchResult &result : results)
+        for (const u64 value : { result.nodes, (u64)result.bestMove.encoded() })
+            checksum ^= value + 0x9E3779B97F4A7C15ULL + (checksum << 6) + (checksum >> 2);
+
+    return checksum;
+}
+
+// JSON report with one position per line, so that benchCompare() can read it back
+inline void benchWriteJson(
+    const std::string &jsonFile,
+    const std::vector<BenchResult> &results,
+    const int depth,
+    const int numThreads,
+    const i64 hashMB)
+{
+    std::ofstream file(jsonFile);
+
+    if (!file.is_open()) {
+        std::cout << "info string Failed to open " << jsonFile << std::endl;
+        return;
+    }
+
+    u64 totalNodes = 0, totalMilliseconds = 0;
+
+    file << "{\n"
+         << "  \"depth\": "   << depth      << ",\n"
+         << "  \"threads\": " << numThreads << ",\n"
+         << "  \"hashMB\": "  << hashMB     << ",\n"
+         << "  \"positions\": [\n";
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult &result = results[i];
+
+        file << "    {\"fen\": \""     << result.fen          << "\""
+             << ", \"nodes\": "        << result.nodes
+             << ", \"time\": "         << result.milliseconds
+             << ", \"nps\": "          << result.nps()
+             << ", \"depth\": "        << result.depth
+             << ", \"bestmove\": \""   << result.bestMove.toUci() << "\"}"
+             << (i + 1 < results.size() ? ",\n" : "\n");
+
+        totalNodes += result.nodes;
+        totalMilliseconds += result.milliseconds;
+    }
+
+    file << "  ],\n"
+         << "  \"nodes\": "    << totalNodes        << ",\n"
+         << "  \"time\": "     << totalMilliseconds << ",\n"
+         << "  \"nps\": "      << totalNodes * 1000 / std::max<u64>(totalMilliseconds, 1) << ",\n"
+         << "  \"checksum\": " << benchChecksum(results) << "\n"
+         << "}" << std::endl;
+
+    std::cout << "info string Bench report written to " << jsonFile << std::endl;
+}
+
+// Value of "key" in a JSON line written by benchWriteJson(), without quotes
+inline std::string benchJsonValue(const std::string &line, const std::string &key)
+{
+    const std::string pattern = "\"" + key + "\": ";
+    size_t start = line.find(pattern);
+
+    if (start == std::string::npos) return "";
+
+    start += pattern.size();
+
+    if (line[start] == '"')
+        return line.substr(start + 1, line.find('"', start + 1) - start - 1);
+
+    return line.substr(start, line.find_first_of(",}", start) - start);
+}
+
+// Parses the unsigned integer value of "key" in a JSON line written by benchWriteJson()
+// Returns false if the key is missing or its value isn't all digits
+inline bool benchJsonU64(const std::string &line, const std::string &key, u64 &value)
+{
+    const std::string str = benchJsonValue(line, key);
+    const auto [ptr, errorCode] = std::from_chars(str.data(), str.data() + str.size(), value);
+
+    return !str.empty() && errorCode == std::errc() && ptr == str.data() + str.size();
+}
+
+// Compares results against a JSON report from a previous bench
+// Positions whose nps dropped more than the threshold are flagged as regressions
+inline void benchCompare(const std::string &baselineFile, const std::vector<BenchResult> &results)
+{
+    constexpr double NPS_REGRESSION_THRESHOLD = 0.05;
+
+    std::ifstream file(baselineFile);
+
+    if (!file.is_open()) {
+        std::cout << "info string Failed to open " << baselineFile << std::endl;
+        return;
+    }
+
+    std::vector<BenchResult> baseline = { };
+    std::string line;
+    size_t lineNumber = 0;
+
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+
+        if (benchJsonValue(line, "fen") == "") continue;
+
+        BenchResult result = BenchResult();
+        result.fen = benchJsonValue(line, "fen");
+
+        if (!benchJsonU64(line, "nodes", result.nodes) || !benchJsonU64(line, "time", result.milliseconds))
+        {
+            std::cout << "info string Skipping malformed baseline line "
+                      << lineNumber << ": " << line << std::endl;
+            continue;
+        }
+
+        baseline.push_back(result);
+    }
+
+    u64 baseNodes = 0, baseMs = 0, nodes = 0, milliseconds = 0;
+    size_t regressions = 0, nodesMismatches = 0;
+
+    for (const BenchResult &result : results)
+    {
+        const auto baseIt = std::find_if(baseline.begin(), baseline.end(),
+            [&](const BenchResult &base) { return base.fen == result.fen; });
+
+        if (baseIt == baseline.end()) {
+            std::cout << "not in baseline " << result.fen << std::endl;
+            continue;
+        }
+
+        const double npsChange = (double)result.nps() / (double)std::max<u64>(baseIt->nps(), 1) - 1.0;
+        const bool regression = npsChange < -NPS_REGRESSION_THRESHOLD;
+
+        regressions += regression;
+        nodesMismatches += result.nodes != baseIt->nodes;
+
+        std::cout << (regression ? "REGRESSION " : "")
+                  << "nps "    << baseIt->nps() << " -> " << result.nps()
+                  << " ("      << std::showpos << round(npsChange * 1000.0) / 10.0 << std::noshowpos << "%)"
+                  << " nodes " << baseIt->nodes << " -> " << result.nodes
+                  << " fen "   << result.fen
+                  << std::endl;
+
+        baseNodes += baseIt->nodes;
+        baseMs += baseIt->milliseconds;
+        nodes += result.nodes;
+        milliseconds += result.milliseconds;
+    }
+
+    const u64 baseNps = baseNodes * 1000 / std::max<u64>(baseMs, 1);
+    const u64 nps = nodes * 1000 / std::max<u64>(milliseconds, 1);
+
+    std::cout << "total nps " << baseNps << " -> " << nps
+              << " ("         << std::showpos << round(((double)nps / std::max<double>(baseNps, 1) - 1.0) * 1000.0) / 10.0
+              << std::noshowpos << "%)"
+              << " regressions " << regressions
+              << " nodes mismatches " << nodesMismatches
+              << std::endl;
+}
+
+// Prints "<nodes> nodes <nps> nps" as the last line
+// If jsonFile isn't empty, writes a JSON report to it
+// If baselineFile isn't empty, compares against that JSON report
+// If perf, also prints hardware performance counters
+inline void bench(
+    const int depth = 14,
+    const int numThreads = 1,
+    const i64 hashMB = 32,
+    const std::string &fensFile = "default",
+    const std::string &jsonFile = "",
+    const std::string &baselineFile = "",
+    const bool perf = false)
 {
+    // Open counters before creating the searcher so that its threads are counted
+    std::unique_ptr<PerfCounters> perfCounters = perf ? std::make_unique<PerfCounters>() : nullptr;
+
     Searcher searcher = Searcher();
 
+    if (numThreads != 1) searcher.setThreads(numThreads);
+    if (hashMB != 32) resizeTT(searcher.mTT, hashMB);
+
+    std::vector<BenchResult> results = { };
     u64 totalNodes = 0, totalMilliseconds = 0;
 
-    for (const std::string fen : BENCH_FENS)
+    const std::vector<std::string> fens = benchFens(fensFile);
+
+    #if defined(PROFILE)
+        profileReset();
+    #endif
+
+    if (perfCounters) perfCounters->start();
+
+    for (const std::string &fen : fens)
     {
-        searcher.ucinewgame();
-        searcher.board() = Board(fen);
-
-        const std::chrono::time_point<std::chrono::steady_clock> startTime = std::chrono::steady_clock::now();
-
-        searcher.search(
-            depth,
-            std::numeric_limits<u64>::max(),
-            startTime,
-            std::numeric_limits<u64>::max(),
-            std::numeric_limits<u64>::max(),
-            false
-        );
-
-        totalMilliseconds += millisecondsElapsed(startTime);
-        totalNodes += searcher.totalNodes();
+        const BenchResult result = benchPosition(searcher, fen, depth);
+
+        totalNodes += result.nodes;
+        totalMilliseconds += result.milliseconds;
+        results.push_back(result);
     }
 
+    if (perfCounters) {
+        perfCounters->stop();
+        perfCounters->print(totalNodes);
+    }
+
+    #if defined(PROFILE)
+        profilePrint(totalNodes);
+    #endif
+
+    if (jsonFile != "")
+        benchWriteJson(jsonFile, results, depth, numThreads, hashMB);
+
+    if (baselineFile != "")
+        benchCompare(baselineFile, results);
+
     std::cout << totalNodes << " nodes "
               << totalNodes * 1000 / std::max((u64)totalMilliseconds, (u64)1) << " nps"
               << std::endl;
 }
+
+// Runs the bench positions with 1, 2, 4... maxThreads threads
+// Reports nps and time to depth relative to 1 thread,
+// and how often the best move matches the 1 thread best move
+inline void benchSMP(const int depth, const int maxThreads, const i64 hashMB)
+{
+    std::cout << "SMP bench depth " << depth
+              << " max threads "    << maxThreads
+              << " hash "           << hashMB << " MB"
+              << std::endl;
+
+    std::vector<int> threadCounts = { };
+
+    for (int numThreads = 1; numThreads < maxThreads; numThreads *= 2)
+        threadCounts.push_back(numThreads);
+
+    threadCounts.push_back(std::max(maxThreads, 1));
+
+    u64 singleThreadNps = 0, singleThreadMs = 0;
+    std::vector<Move> singleThreadBestMoves = { };
+
+    for (const int numThreads : threadCounts)
+    {
+        Searcher searcher = Searcher();
+        resizeTT(searcher.mTT, hashMB);
+        searcher.setThreads(numThreads);
+
+        u64 totalNodes = 0, totalMilliseconds = 0;
+        size_t sameBestMove = 0;
+
+        for (size_t i = 0; i < BENCH_FENS.size(); i++)
+        {
+            const BenchResult result = benchPosition(searcher, BENCH_FENS[i], depth);
+
+            totalNodes += result.nodes;
+            totalMilliseconds += result.milliseconds;
+
+            if (numThreads == 1)
+                singleThreadBestMoves.push_back(result.bestMove);
+
+            sameBestMove += result.bestMove == singleThreadBestMoves[i];
+        }
+
+        totalMilliseconds = std::max<u64>(totalMilliseconds, 1);
+        const u64 nps = totalNodes * 1000 / totalMilliseconds;
+
+        if (numThreads == 1) {
+            singleThreadNps = std::max<u64>(nps, 1);
+            singleThreadMs = totalMilliseconds;
+        }
+
+        std::cout << "threads "       << numThreads
+                  << " nodes "        << totalNodes
+                  << " time "         << totalMilliseconds
+                  << " nps "          << nps
+                  << " nps scaling "  << (double)nps / (double)singleThreadNps
+                  << " ttd speedup "  << (double)singleThreadMs / (double)totalMilliseconds
+                  << " bestmove agreement " << sameBestMove * 100 / BENCH_FENS.size() << "%"
+                  << std::endl;
+    }
+}
@@ -7,6 +7,7 @@
 #include "move.hpp"
 #include "search_params.hpp" // SEE piece values
 #include "cuckoo.hpp"
+#include "profiler.hpp"
 
 const std::string START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 
@@ -33,6 +34,33 @@ struct BoardState {
     std::array<u64, 2> nonPawnsHashes = { }; // [pieceColor]
 } __attribute__((packed));
 
+// Game result, from white's perspective
+enum class WDL : u8 {
+    BLACK_WIN = 0, DRAW = 1, WHITE_WIN = 2
+};
+
+// 32-byte position (marlinformat layout), see Board::pack() and Board(PackedBoard)
+// pieces: 1 nibble per piece, in occupancy lsb to msb order, (color << 3) | pieceType
+// where pieceType 6 is a rook that can still castle
+// stmEpSquare: bit 7 is side to move (1 = black), bits 0-6 are en passant square (64 = none)
+// score and wdl: score from white's perspective and game result, e.g. in training data
+struct PackedBoard {
+    public:
+    u64 occupancy = 0;
+    std::array<u8, 16> pieces = { };
+    u8 stmEpSquare = 0;
+    u8 halfmoveClock = 0;
+    u16 fullmoveCounter = 1;
+    i16 score = 0;
+    WDL wdl = WDL::DRAW;
+    u8 extra = 0;
+
+    // Defined after Board
+    inline bool isValid() const;
+} __attribute__((packed));
+
+static_assert(sizeof(PackedBoard) == 32);
+
 class Board {
     private:
 
@@ -143,6 +171,55 @@ class Board {
         state().checkers = attackers(kingSquare()) & them();
     }
 
+    inline Board(const PackedBoard &packed)
+    {
+        mStates = { };
+        mStates.reserve(512);
+        mStates.push_back(BoardState());
+
+        state().colorToMove = (packed.stmEpSquare >> 7) ? Color::BLACK : Color::WHITE;
+
+        if (state().colorToMove == Color::BLACK)
+            state().zobristHash ^= ZOBRIST_COLOR;
+
+        // Pieces and castling rights (rooks that can still castle)
+
+        u64 occ = packed.occupancy;
+        int i = 0;
+
+        while (occ > 0)
+        {
+            const Square square = poplsb(occ);
+            const u8 nibble = (packed.pieces[i / 2] >> (i % 2 * 4)) & 0b1111;
+            const Color color = (nibble >> 3) ? Color::BLACK : Color::WHITE;
+            u8 pieceType = nibble & 0b111;
+
+            if (pieceType == 6) {
+                pieceType = (u8)PieceType::ROOK;
+                state().castlingRights |= bitboard(square);
+            }
+
+            placePiece(color, (PieceType)pieceType, square);
+            i++;
+        }
+
+        state().zobristHash ^= state().castlingRights;
+
+        // En passant square
+
+        const u8 epSquare = packed.stmEpSquare & 0b111'1111;
+
+        if (epSquare < 64) {
+            state().enPassantSquare = epSquare;
+            state().zobristHash ^= ZOBRIST_FILES[(int)squareFile(epSquare)];
+        }
+
+        state().pliesSincePawnOrCapture = packed.halfmoveClock;
+        state().currentMoveCounter = packed.fullmoveCounter;
+
+        state().checkers = attackers(kingSquare()) & them();
+    }
+
     constexpr Color sideToMove() const { return state().colorToMove; }
 
     constexpr Color oppSide() const { return oppColor(state().colorToMove); }
@@ -329,6 +406,37 @@ class Board {
         return myFen;
     }
 
+    constexpr PackedBoard pack(const i16 whiteScore = 0, const WDL wdl = WDL::DRAW) const
+    {
+        PackedBoard packed = PackedBoard();
+        packed.occupancy = occupancy();
+
+        u64 occ = packed.occupancy;
+        int i = 0;
+
+        while (occ > 0)
+        {
+            const Square square = poplsb(occ);
+            const bool isBlack = getBb(Color::BLACK) & bitboard(square);
+
+            const u8 pieceType = state().castlingRights & bitboard(square)
+                                 ? 6 : (u8)pieceTypeAt(square);
+
+            packed.pieces[i / 2] |= ((isBlack << 3) | pieceType) << (i % 2 * 4);
+            i++;
+        }
+
+        const u8 epSquare = state().enPassantSquare == SQUARE_NONE ? 64 : state().enPassantSquare;
+        packed.stmEpSquare = ((sideToMove() == Color::BLACK) << 7) | epSquare;
+
+        packed.halfmoveClock = state().pliesSincePawnOrCapture;
+        packed.fullmoveCounter = state().currentMoveCounter;
+        packed.score = whiteScore;
+        packed.wdl = wdl;
+
+        return packed;
+    }
+
     inline void print() const {
         std::string str = "";
 
@@ -570,6 +678,8 @@ class Board {
      // SEE (Static exchange evaluation)
     constexpr bool SEE(const Move move, const i32 threshold = 0) const
     {
+        PROFILE_SCOPE(ProfilePhase::SEE);
+
         assert(move != MOVE_NONE);
 
         #if defined(TUNE)
@@ -1114,6 +1224,8 @@ class Board {
     // Cuckoo / detect upcoming repetition
     constexpr bool hasUpcomingRepetition(const int ply) const
     {
+        PROFILE_SCOPE(ProfilePhase::UPCOMING_REPETITION);
+
         const int end = std::min(int(state().pliesSincePawnOrCapture), int(mStates.size()) - 1);
         if (end < 3) return false;
 
@@ -1362,6 +1474,178 @@ class Board {
 
 }; // class Board
 
+// Board(PackedBoard) and move gen trust every field, so check everything they rely on
+// (like isValidFen()), e.g. for records read from files
+inline bool PackedBoard::isValid() const
+{
+    // 16 bytes of nibbles hold at most 32 pieces
+    if (std::popcount(occupancy) > 32) return false;
+
+    std::array<int, 2> numKings = { 0, 0 }; // [color]
+    std::array<bool, 2> hasCastlingRook = { false, false }; // [color]
+
+    u64 occ = occupancy;
+    int i = 0;
+
+    while (occ > 0)
+    {
+        const Square square = poplsb(occ);
+        const u8 nibble = (pieces[i / 2] >> (i % 2 * 4)) & 0b1111;
+        const int color = nibble >> 3;
+        const u8 pieceType = nibble & 0b111;
+
+        if (pieceType > 6) return false;
+
+        if (pieceType == (u8)PieceType::PAWN
+        && (squareRank(square) == Rank::RANK_1 || squareRank(square) == Rank::RANK_8))
+            return false;
+
+        if (pieceType == (u8)PieceType::KING)
+            numKings[color]++;
+
+        // A rook that can still castle must be on one of its side's back rank corners
+        if (pieceType == 6)
+        {
+            const Square cornerSquare = color == (int)Color::WHITE ? 0 : 56;
+
+            if (square != cornerSquare && square != cornerSquare + 7)
+                return false;
+
+            hasCastlingRook[color] = true;
+        }
+
+        i++;
+    }
+
+    if (numKings[(int)Color::WHITE] != 1 || numKings[(int)Color::BLACK] != 1)
+        return false;
+
+    const u8 epSquare = stmEpSquare & 0b111'1111;
+
+    if (epSquare > 64) return false;
+
+    const Board board = Board(*this);
+
+    // Castling needs our king on its start square, since move gen assumes so
+    for (const Color color : { Color::WHITE, Color::BLACK })
+        if (hasCastlingRook[(int)color] && board.kingSquare(color) != (color == Color::WHITE ? 4 : 60))
+            return false;
+
+    // En passant square must be behind an enemy pawn that just moved 2 squares
+    if (epSquare < 64)
+    {
+        const Rank epRank = board.sideToMove() == Color::WHITE ? Rank::RANK_6 : Rank::RANK_3;
+        const Square pawnSquare     = board.sideToMove() == Color::WHITE ? epSquare - 8 : epSquare + 8;
+        const Square pawnFromSquare = board.sideToMove() == Color::WHITE ? epSquare + 8 : epSquare - 8;
+
+        if (squareRank(epSquare) != epRank
+        || board.isOccupied(epSquare)
+        || board.isOccupied(pawnFromSquare)
+        || (board.getBb(board.oppSide(), PieceType::PAWN) & bitboard(pawnSquare)) == 0)
+            return false;
+    }
+
+    // Side not to move can't be in check
+    return (board.attackers(board.kingSquare(board.oppSide())) & board.us()) == 0;
+}
+
+// Board(fen) and move gen assume a valid FEN, so check everything they rely on
+inline bool isValidFen(std::string fen)
+{
+    const std::vector<std::string> fenSplit = splitString(fen, ' ');
+
+    if (fenSplit.size() < 4 || fenSplit.size() > 6) return false;
+
+    // Pieces
+
+    int rank = 7, file = 0;
+    std::array<int, 2> numKings = { 0, 0 }; // [color]
+
+    for (const char thisChar : fenSplit[0])
+    {
+        if (thisChar == '/') {
+            if (file != 8 || rank == 0) return false;
+            rank--;
+            file = 0;
+        }
+        else if (thisChar >= '1' && thisChar <= '8')
+            file += thisChar - '0';
+        else if (std::string("pnbrqkPNBRQK").find(thisChar) != std::string::npos)
+        {
+            if ((thisChar == 'p' || thisChar == 'P') && (rank == 0 || rank == 7))
+                return false;
+
+            if (thisChar == 'k' || thisChar == 'K')
+                numKings[std::isupper(thisChar) ? WHITE : BLACK]++;
+
+            file++;
+        }
+        else
+            return false;
+
+        if (file > 8) return false;
+    }
+
+    if (rank != 0 || file != 8 || numKings[WHITE] != 1 || numKings[BLACK] != 1)
+        return false;
+
+    // Side to move, castling rights and en passant square characters
+
+    if (fenSplit[1] != "w" && fenSplit[1] != "b")
+        return false;
+
+    if (fenSplit[2] != "-" && fenSplit[2].find_first_not_of("KQkq") != std::string::npos)
+        return false;
+
+    // En passant square must be behind a pawn that just moved 2 squares
+    const char epRank = fenSplit[1] == "w" ? '6' : '3';
+
+    if (fenSplit[3] != "-"
+    && (fenSplit[3].size() != 2 || fenSplit[3][0] < 'a' || fenSplit[3][0] > 'h' || fenSplit[3][1] != epRank))
+        return false;
+
+    // Halfmove clock (u8) and fullmove counter (u16)
+
+    for (size_t i = 4; i < fenSplit.size(); i++)
+        if (fenSplit[i].size() > 4 || fenSplit[i].find_first_not_of("0123456789") != std::string::npos)
+            return false;
+
+    if (fenSplit.size() > 4 && stoi(fenSplit[4]) > 255)
+        return false;
+
+    const Board board = Board(fen);
+
+    // Each castling right needs our king on its start square and our rook on that corner,
+    // since move gen assumes so
+
+    if (fenSplit[2] != "-")
+        for (const char thisChar : fenSplit[2])
+        {
+            const Color color = std::isupper(thisChar) ? Color::WHITE : Color::BLACK;
+            const Square kingSquare = color == Color::WHITE ? 4 : 60;
+            const Square rookSquare = kingSquare + (thisChar == 'K' || thisChar == 'k' ? 3 : -4);
+
+            if (board.kingSquare(color) != kingSquare
+            || (board.getBb(color, PieceType::ROOK) & bitboard(rookSquare)) == 0)
+                return false;
+        }
+
+    if (fenSplit[3] != "-")
+    {
+        const Square epSquare = strToSquare(fenSplit[3]);
+        const Square pawnSquare     = board.sideToMove() == Color::WHITE ? epSquare - 8 : epSquare + 8;
+        const Square pawnFromSquare = board.sideToMove() == Color::WHITE ? epSquare + 8 : epSquare - 8;
+
+        if (board.isOccupied(epSquare)
+        || board.isOccupied(pawnFromSquare)
+        || (board.getBb(board.oppSide(), PieceType::PAWN) & bitboard(pawnSquare)) == 0)
+            return false;
+    }
+
+    // Side not to move can't be in check
+    return (board.attackers(board.kingSquare(board.oppSide())) & board.us()) == 0;
+}
+
 constexpr u64 perft(Board &board, const int depth)
 {
     if (depth <= 0) return 1;
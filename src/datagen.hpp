@@ -0,0 +1,275 @@
+// clang-format off
+
+#pragma once
+
+#include "utils.hpp"
+#include "board.hpp"
+#include "search.hpp"
+#include "packed_board_io.hpp"
+#include <fstream>
+#include <random>
+
+// Self-play training data generation
+
+constexpr i64 DATAGEN_HASH_MB = 16;
+
+// Hard nodes limit of each search = soft nodes limit * this
+constexpr u64 DATAGEN_HARD_NODES_MUL = 20;
+
+// Openings: random legal moves from startpos, or from a random book position
+constexpr int DATAGEN_RANDOM_PLIES = 8; // +0 or +1, so both sides get to move first
+constexpr int DATAGEN_BOOK_RANDOM_PLIES = 2;
+
+// Openings whose first search score is bigger than this are discarded
+constexpr i32 DATAGEN_MAX_OPENING_SCORE = 1000;
+
+// A thread gives up if this many openings in a row are discarded (e.g. a book of lost positions)
+constexpr int DATAGEN_MAX_OPENING_TRIES = 1000;
+
+// Win adjudication: score (white's perspective) >= WIN_SCORE or <= -WIN_SCORE for WIN_PLIES consecutive plies
+constexpr i32 DATAGEN_WIN_SCORE = 2500;
+constexpr int DATAGEN_WIN_PLIES = 4;
+
+// Draw adjudication: abs(score) <= DRAW_SCORE for DRAW_PLIES consecutive plies, after DRAW_MIN_PLY
+constexpr i32 DATAGEN_DRAW_SCORE = 10;
+constexpr int DATAGEN_DRAW_PLIES = 10;
+constexpr int DATAGEN_DRAW_MIN_PLY = 80;
+
+constexpr int DATAGEN_MAX_PLIES = 600; // draw if reached
+
+constexpr u64 DATAGEN_PRINT_EVERY_GAMES = 100;
+
+inline std::vector<Move> legalMoves(Board &board)
+{
+    ArrayVec<Move, 256> moves;
+    board.pseudolegalMoves(moves, MoveGenType::ALL);
+
+    std::vector<Move> legal = { };
+
+    for (const Move move : moves)
+        if (board.isPseudolegalLegal(move))
+            legal.push_back(move);
+
+    return legal;
+}
+
+// Plays a random opening, or returns false if it has no legal moves at some point
+inline bool datagenOpening(
+    Board &board, const std::vector<std::string> &bookFens, std::mt19937_64 &rng)
+{
+    board = bookFens.empty() ? START_BOARD : Board(bookFens[rng() % bookFens.size()]);
+
+    const int randomPlies = bookFens.empty()
+                            ? DATAGEN_RANDOM_PLIES + int(rng() % 2)
+                            : DATAGEN_BOOK_RANDOM_PLIES;
+
+    for (int ply = 0; ply < randomPlies; ply++)
+    {
+        const std::vector<Move> moves = legalMoves(board);
+
+        if (moves.empty()) return false;
+
+        board.makeMove(moves[rng() % moves.size()]);
+    }
+
+    return board.hasLegalMove();
+}
+
+// Plays self-play games until numGames are completed, each thread playing its own games
+// Appends the positions of each game to outFile, when the game ends
+// Positions in check, with a noisy best move or with a mate score are skipped
+inline void datagen(
+    const std::string &outFile,
+    const int numThreads,
+    const u64 numGames,
+    const u64 softNodes,
+    const std::string &bookFile)
+{
+    std::vector<std::string> bookFens = { };
+
+    if (bookFile != "") {
+        std::ifstream book(bookFile);
+        std::string line;
+        u64 linesRead = 0;
+
+        if (!book.is_open()) {
+            std::cout << "info string Failed to open " << bookFile << std::endl;
+            return;
+        }
+
+        while (std::getline(book, line))
+        {
+            linesRead++;
+            trim(line);
+
+            if (line == "") continue;
+
+            if (!isValidFen(line)) {
+                std::cout << "info string Skipping invalid FEN on book line " << linesRead << ": " << line << std::endl;
+                continue;
+            }
+
+            bookFens.push_back(line);
+        }
+
+        if (bookFens.empty()) {
+            std::cout << "info string No positions in book " << bookFile << std::endl;
+            return;
+        }
+    }
+
+    PackedBoardWriter writer(outFile, true);
+
+    if (!writer.isOpen()) {
+        std::cout << "info string Failed to open " << outFile << std::endl;
+        return;
+    }
+
+    std::cout << "datagen output "   << outFile
+              << " threads "         << numThreads
+              << " games "           << numGames
+              << " soft nodes "      << softNodes
+              << " book "            << (bookFile == "" ? "none" : bookFile)
+              << std::endl;
+
+    const std::chrono::time_point<std::chrono::steady_clock> startTime = std::chrono::steady_clock::now();
+
+    std::mutex outMutex;
+    std::atomic<u64> gamesStarted = 0;
+    u64 gamesFinished = 0, positionsWritten = 0; // protected by outMutex
+    std::array<u64, 3> results = { }; // [WDL], protected by outMutex
+
+    const auto worker = [&](const int threadIdx)
+    {
+        std::mt19937_64 rng(std::random_device{}() ^ (u64(threadIdx) * 0x9E3779B97F4A7C15ULL));
+
+        Searcher searcher = Searcher(false);
+        resizeTT(searcher.mTT, DATAGEN_HASH_MB);
+
+        std::vector<PackedBoard> entries = { };
+        entries.reserve(DATAGEN_MAX_PLIES);
+
+        while (gamesStarted.fetch_add(1) < numGames)
+        {
+            // Play openings until one is playable and balanced
+            bool openingFound = false;
+
+            for (int tries = 0; tries < DATAGEN_MAX_OPENING_TRIES && !openingFound; tries++)
+            {
+                searcher.ucinewgame();
+
+                if (!datagenOpening(searcher.board(), bookFens, rng))
+                    continue;
+
+                const i32 score = searcher.searchSync(
+                    MAX_DEPTH, softNodes * DATAGEN_HARD_NODES_MUL, softNodes
+                ).second;
+
+                openingFound = abs(score) <= DATAGEN_MAX_OPENING_SCORE;
+            }
+
+            if (!openingFound) {
+                std::lock_guard<std::mutex> lock(outMutex);
+
+                std::cout << "info string Thread " << threadIdx << " found no playable and balanced opening in "
+                          << DATAGEN_MAX_OPENING_TRIES << " tries, stopping it" << std::endl;
+
+                break;
+            }
+
+            Board &board = searcher.board();
+            entries.clear();
+
+            int winPlies = 0, lossPlies = 0, drawPlies = 0;
+            WDL wdl = WDL::DRAW;
+
+            for (int ply = 0; ply < DATAGEN_MAX_PLIES; ply++)
+            {
+                const auto [bestMove, score] = searcher.searchSync(
+                    MAX_DEPTH, softNodes * DATAGEN_HARD_NODES_MUL, softNodes
+                );
+
+                assert(bestMove != MOVE_NONE);
+
+                const i32 whiteScore = board.sideToMove() == Color::WHITE ? score : -score;
+
+                if (!board.inCheck() && board.isQuiet(bestMove) && abs(score) < MIN_MATE_SCORE)
+                    entries.push_back(board.pack(std::clamp<i32>(whiteScore, -32767, 32767)));
+
+                // Adjudication
+
+                winPlies  = whiteScore >=  DATAGEN_WIN_SCORE ? winPlies  + 1 : 0;
+                lossPlies = whiteScore <= -DATAGEN_WIN_SCORE ? lossPlies + 1 : 0;
+
+                drawPlies = ply >= DATAGEN_DRAW_MIN_PLY && abs(score) <= DATAGEN_DRAW_SCORE
+                            ? drawPlies + 1 : 0;
+
+                if (winPlies >= DATAGEN_WIN_PLIES) {
+                    wdl = WDL::WHITE_WIN;
+                    break;
+                }
+
+                if (lossPlies >= DATAGEN_WIN_PLIES) {
+                    wdl = WDL::BLACK_WIN;
+                    break;
+                }
+
+                if (drawPlies >= DATAGEN_DRAW_PLIES)
+                    break;
+
+                board.makeMove(bestMove);
+
+                // Checkmate or stalemate
+                if (!board.hasLegalMove())
+                {
+                    if (board.inCheck())
+                        wdl = board.sideToMove() == Color::WHITE ? WDL::BLACK_WIN : WDL::WHITE_WIN;
+
+                    break;
+                }
+
+                // 50 moves rule, insufficient material or threefold repetition
+                if (board.isDraw(0)) break;
+            }
+
+            for (PackedBoard &entry : entries)
+                entry.wdl = wdl;
+
+            std::lock_guard<std::mutex> lock(outMutex);
+
+            writer.write(entries);
+
+            gamesFinished++;
+            positionsWritten += entries.size();
+            results[(int)wdl]++;
+
+            if (gamesFinished % DATAGEN_PRINT_EVERY_GAMES == 0 || gamesFinished == numGames)
+            {
+                writer.flush();
+
+                const u64 ms = std::max<u64>(millisecondsElapsed(startTime), 1);
+
+                std::cout << "games "           << gamesFinished
+                          << " positions "      << positionsWritten
+                          << " positions/hour " << positionsWritten * 3'600'000 / ms
+                          << " white wins "     << results[(int)WDL::WHITE_WIN]
+                          << " draws "          << results[(int)WDL::DRAW]
+                          << " black wins "     << results[(int)WDL::BLACK_WIN]
+                          << " time "           << ms
+                          << std::endl;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads = { };
+
+    for (int i = 0; i < numThreads; i++)
+        threads.push_back(std::thread(worker, i));
+
+    for (std::thread &thread : threads)
+        thread.join();
+
+    std::cout << "datagen finished, wrote " << positionsWritten
+              << " positions to " << outFile
+              << std::endl;
+}
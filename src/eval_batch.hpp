@@ -0,0 +1,167 @@
+// clang-format off
+
+#pragma once
+
+#include "utils.hpp"
+#include "board.hpp"
+#include "nnue.hpp"
+#include "packed_board_io.hpp"
+#include <fstream>
+#include <thread>
+#include <memory>
+
+// Batch static evaluation of a position file
+
+// Positions are evaluated in chunks of this many, which bounds memory
+constexpr size_t EVAL_BATCH_CHUNK_POSITIONS = 1 << 16;
+
+// Positions with the same king squares use the same finny table entries
+// (unless their enemy queen input bucket differs),
+// and positions with the same occupancy are likely to have few different pieces
+constexpr std::pair<u16, u64> finnySortKey(const PackedBoard &packed)
+{
+    u16 kingSquares = 0;
+    u64 occ = packed.occupancy;
+    int i = 0;
+
+    while (occ > 0)
+    {
+        const Square square = poplsb(occ);
+        const u8 nibble = (packed.pieces[i / 2] >> (i % 2 * 4)) & 0b1111;
+
+        if ((nibble & 0b111) == (u8)PieceType::KING)
+            kingSquares |= u16(square) << (nibble >> 3 ? 6 : 0);
+
+        i++;
+    }
+
+    return { kingSquares, packed.occupancy };
+}
+
+// Evaluates every position of inFile (.bin PackedBoard records or FEN lines) with numThreads threads
+// Writes the raw net evals, from white's perspective, to outFile as an array of i16, in input order
+// Within a chunk, positions are sorted with finnySortKey() and each thread evaluates a contiguous
+// range of the sorted positions, so accumulators are finny table diffs instead of full refreshes
+inline void evalBatch(const std::string &inFile, const std::string &outFile, const int numThreads)
+{
+    const bool packed = isPackedFile(inFile);
+
+    std::ifstream fenIn;
+    std::unique_ptr<PackedBoardReader> packedIn = nullptr;
+
+    if (packed)
+        packedIn = std::make_unique<PackedBoardReader>(inFile);
+    else
+        fenIn.open(inFile);
+
+    if (packed ? !packedIn->isOpen() : !fenIn.is_open()) {
+        std::cout << "info string Failed to open " << inFile << std::endl;
+        return;
+    }
+
+    std::ofstream out(outFile, std::ios::binary);
+
+    if (!out) {
+        std::cout << "info string Failed to open " << outFile << std::endl;
+        return;
+    }
+
+    const std::chrono::time_point<std::chrono::steady_clock> startTime = std::chrono::steady_clock::now();
+
+    std::vector<PackedBoard> chunk = { };
+    std::vector<std::pair<std::pair<u16, u64>, u32>> sortedIdxs = { }; // [sort key, chunk idx]
+    std::vector<i16> evals = { };
+
+    std::vector<std::unique_ptr<FinnyTable>> finnyTables = { }; // [thread]
+
+    for (int i = 0; i < numThreads; i++)
+    {
+        finnyTables.push_back(std::make_unique<FinnyTable>());
+        nnue::resetFinnyTable(*finnyTables.back());
+    }
+
+    u64 positionsEvaluated = 0, linesRead = 0, invalidLines = 0;
+
+    while (true) {
+        chunk.clear();
+
+        if (packed)
+            packedIn->read(chunk, EVAL_BATCH_CHUNK_POSITIONS);
+        else {
+            std::string line;
+
+            while (chunk.size() < EVAL_BATCH_CHUNK_POSITIONS && std::getline(fenIn, line))
+            {
+                linesRead++;
+
+                // Ignore anything after the fen, e.g. "<fen> | <score> | <result>"
+                line = line.substr(0, line.find('|'));
+                trim(line);
+
+                if (line == "") continue;
+
+                if (!isValidFen(line)) {
+                    std::cout << "info string Skipping invalid FEN on line " << linesRead << ": " << line << std::endl;
+                    invalidLines++;
+                    continue;
+                }
+
+                chunk.push_back(Board(line).pack());
+            }
+        }
+
+        if (chunk.empty()) break;
+
+        sortedIdxs.clear();
+
+        for (size_t i = 0; i < chunk.size(); i++)
+            sortedIdxs.push_back({ finnySortKey(chunk[i]), i });
+
+        std::sort(sortedIdxs.begin(), sortedIdxs.end());
+
+        evals.resize(chunk.size());
+
+        const auto worker = [&](const int threadIdx)
+        {
+            FinnyTable &finnyTable = *finnyTables[threadIdx];
+
+            const size_t begin = chunk.size() * threadIdx / numThreads;
+            const size_t end = chunk.size() * (threadIdx + 1) / numThreads;
+
+            for (size_t i = begin; i < end; i++)
+            {
+                const u32 chunkIdx = sortedIdxs[i].second;
+                const Board board = Board(chunk[chunkIdx]);
+                const BothAccumulators bothAccs = BothAccumulators(board, finnyTable);
+
+                const i32 eval = nnue::evaluate(&bothAccs, board.sideToMove());
+                const i32 whiteEval = board.sideToMove() == Color::WHITE ? eval : -eval;
+
+                evals[chunkIdx] = std::clamp<i32>(whiteEval, -32767, 32767);
+            }
+        };
+
+        std::vector<std::thread> threads = { };
+
+        for (int i = 0; i < numThreads; i++)
+            threads.push_back(std::thread(worker, i));
+
+        for (std::thread &thread : threads)
+            thread.join();
+
+        out.write(reinterpret_cast<const char*>(evals.data()), evals.size() * sizeof(i16));
+        positionsEvaluated += evals.size();
+    }
+
+    out.flush();
+
+    const u64 ms = std::max<u64>(millisecondsElapsed(startTime), 1);
+
+    std::cout << "evalbatch positions " << positionsEvaluated
+              << " positions/sec "      << positionsEvaluated * 1000 / ms
+              << " time "               << ms
+              << (packed ? " invalid records " : " invalid FEN lines ")
+              << (packed ? packedIn->invalidRecords() : invalidLines)
+              << " output "             << outFile
+              << std::endl;
+}
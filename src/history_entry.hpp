@@ -20,19 +20,20 @@ constexpr void updateHistory(i16 &history, const i32 bonus) {
     updateHistory(&history, bonus);
 }
 
-struct HistoryEntry {
-    private:
+// Per-node inputs of the quiet history kernel, computed once before scoring all quiets
+struct QuietHistoryWeights {
+    public:
 
-    MultiArray<i16, 2, 2>  mMainHist  = { }; // [enemyAttacksOrigin][enemyAttacksDestination]
-    MultiArray<i16, 6, 64> mContHist  = { }; // [previousMovePieceType][previousMoveTo]
-    MultiArray<i16, 7, 5>  mNoisyHist = { }; // [pieceTypeCaptured][promotionPieceType]
+    // Weights are fixed point, scaled by WEIGHT_SCALE
+    constexpr static i32 WEIGHT_SCALE = 1024;
 
-    public:
+    i32 mainHist = 0;
+    std::array<i32, 3> contHists = { }; // 0 if that last move is MOVE_NONE
 
-    i16 mCorrHist = 0;
+    // [previousMovePieceType * 64 + previousMoveTo] of the last moves
+    std::array<size_t, 3> contHistsIdxs = { };
 
-    constexpr i32 quietHistory(
-        const bool enemyAttacksOrigin, const bool enemyAttacksDst, const std::array<Move, 3> moves) const
+    MAYBE_CONSTEXPR QuietHistoryWeights(const std::array<Move, 3> moves)
     {
         #if defined(TUNE)
             CONT_HIST_WEIGHTS = {
@@ -40,17 +41,41 @@ struct HistoryEntry {
             };
         #endif
 
-        float total = float(mMainHist[enemyAttacksOrigin][enemyAttacksDst]) * mainHistoryWeight();
+        mainHist = round(mainHistoryWeight() * float(WEIGHT_SCALE));
 
-        Move move;
         for (size_t i = 0; i < moves.size(); i++)
-            if ((move = moves[i]) != MOVE_NONE)
+            if (moves[i] != MOVE_NONE)
             {
-                const int pt = int(move.pieceType());
-                total += float(mContHist[pt][move.to()]) * CONT_HIST_WEIGHTS[i];
+                contHists[i] = round(CONT_HIST_WEIGHTS[i] * float(WEIGHT_SCALE));
+                contHistsIdxs[i] = size_t(moves[i].pieceType()) * 64 + moves[i].to();
             }
+    }
+
+}; // struct QuietHistoryWeights
+
+struct HistoryEntry {
+    private:
+
+    MultiArray<i16, 2, 2>  mMainHist  = { }; // [enemyAttacksOrigin][enemyAttacksDestination]
+    MultiArray<i16, 6, 64> mContHist  = { }; // [previousMovePieceType][previousMoveTo]
+    MultiArray<i16, 7, 5>  mNoisyHist = { }; // [pieceTypeCaptured][promotionPieceType]
+
+    public:
+
+    i16 mCorrHist = 0;
+
+    // Branchless integer multiply-adds, missing last moves have weight 0
+    constexpr i32 quietHistory(
+        const bool enemyAttacksOrigin, const bool enemyAttacksDst, const QuietHistoryWeights &weights) const
+    {
+        const i16* contHist = &mContHist[0][0];
+
+        i32 total = i32(mMainHist[enemyAttacksOrigin][enemyAttacksDst]) * weights.mainHist;
+
+        for (size_t i = 0; i < weights.contHists.size(); i++)
+            total += i32(contHist[weights.contHistsIdxs[i]]) * weights.contHists[i];
 
-        return total;
+        return total / QuietHistoryWeights::WEIGHT_SCALE;
     }
 
     constexpr void updateQuietHistories(
@@ -13,20 +13,33 @@ enum class MoveGenStage : int {
 
 constexpr i32 GOOD_SCORE = 1'000'000;
 
+// A move and its score packed in one key: score in the upper 48 bits, move in the lower 16 bits
+// Comparing keys compares scores (ties broken by move encoding)
+constexpr i64 scoredMoveKey(const Move move, const i32 score) {
+    return i64(score) * 65536 + move.encoded();
+}
+
+constexpr Move keyMove(const i64 key) { return Move(u16(key)); }
+
+constexpr i32 keyScore(const i64 key) { return i32(key >> 16); }
+
 // Incremental sorting with partial selection sort
-constexpr Move partialSelectionSort(
-    ArrayVec<Move, 256> &moves, std::array<i32, 256> &movesScores, const int idx)
+// Find the best key in [idx, end) and do a single swap to put it at idx
+constexpr Move partialSelectionSort(ArenaVec<i64> &keys, const int idx, const int end)
 {
-    assert(idx < int(moves.size()));
+    assert(idx < end && end <= int(keys.size()));
 
-    for (size_t i = idx + 1; i < moves.size(); i++)
-        if (movesScores[i] > movesScores[idx])
-        {
-            moves.swap(i, idx);
-            std::swap(movesScores[i], movesScores[idx]);
+    size_t bestIdx = idx;
+    i64 bestKey = keys[idx];
+
+    for (size_t i = idx + 1; i < size_t(end); i++)
+        if (keys[i] > bestKey) {
+            bestKey = keys[i];
+            bestIdx = i;
         }
 
-    return moves[idx];
+    keys.swap(idx, bestIdx);
+    return keyMove(bestKey);
 }
 
 struct MovePicker {
@@ -35,15 +48,17 @@ struct MovePicker {
     MoveGenStage mStage = MoveGenStage::TT_MOVE_NEXT;
     bool mNoisiesOnlyNoUnderpromos;
 
-    ArrayVec<Move, 256> mNoisies, mQuiets;
-    std::array<i32, 256> mNoisiesScores, mQuietsScores;
+    // Scored move keys, noisies in [0, mNoisiesEnd) and quiets in [mNoisiesEnd, size)
+    // Allocated in the thread's arena and sized by the moves actually generated
+    ArenaVec<i64> mMoves;
+    int mNoisiesEnd = 0;
     int mNoisiesIdx = -1, mQuietsIdx = -1;
 
     bool mBadNoisyReady = false;
 
     public:
 
-    constexpr MovePicker(const bool noisiesOnlyNoUnderpromos) {
+    constexpr MovePicker(const bool noisiesOnlyNoUnderpromos, Arena<i64> &arena) : mMoves(arena) {
         mNoisiesOnlyNoUnderpromos = noisiesOnlyNoUnderpromos;
     }
 
@@ -56,7 +71,7 @@ struct MovePicker {
             || mStage == MoveGenStage::BAD_NOISIES
         );
 
-        return mStage == MoveGenStage::QUIETS ? mQuietsScores[mQuietsIdx] : mNoisiesScores[mNoisiesIdx];
+        return keyScore(mMoves[mStage == MoveGenStage::QUIETS ? mQuietsIdx : mNoisiesIdx]);
     }
 
     constexpr Move next(Board &board, const Move ttMove, const Move killer,
@@ -90,60 +105,60 @@ struct MovePicker {
         }
         case MoveGenStage::GEN_SCORE_NOISIES:
         {
+            PROFILE_SCOPE(ProfilePhase::GEN_SCORE_NOISIES);
+
             // Generate pseudolegal noisy moves, except underpromotions
-            board.pseudolegalMoves(mNoisies, MoveGenType::NOISIES, !mNoisiesOnlyNoUnderpromos);
+            ArrayVec<Move, 256> noisies;
+            board.pseudolegalMoves(noisies, MoveGenType::NOISIES, !mNoisiesOnlyNoUnderpromos);
 
             // Score moves
-            size_t i = 0;
-            while (i < mNoisies.size())
+            for (const Move move : noisies)
             {
-                move = mNoisies[i];
-
                 assert(mNoisiesOnlyNoUnderpromos ? board.isNoisyNotUnderpromo(move) : !board.isQuiet(move));
 
-                // Remove TT move and excluded move from list
-                if (move == ttMove || move == excludedMove) {
-                    mNoisies.swap(i, mNoisies.size() - 1);
-                    mNoisies.pop_back();
+                // Skip TT move and excluded move
+                if (move == ttMove || move == excludedMove)
                     continue;
-                }
 
                 const PieceType captured = board.captured(move);
                 const PieceType promotion = move.promotion();
+                i32 score;
 
                 if (mNoisiesOnlyNoUnderpromos)
-                    mNoisiesScores[i] = promotion == PieceType::QUEEN ? GOOD_SCORE : 0;
+                    score = promotion == PieceType::QUEEN ? GOOD_SCORE : 0;
                 else if (promotion == PieceType::QUEEN)
-                    mNoisiesScores[i] = board.SEE(move, 0) ? GOOD_SCORE * 2 : 0;
+                    score = board.SEE(move, 0) ? GOOD_SCORE * 2 : 0;
                 else if (promotion != PieceType::NONE)
                 {
                     // Underpromotions ordering: knight -> rook -> bishop
                     constexpr std::array<i32, 4> UNDERPROMO_BONUS = { 0, 30000, 10000, 20000 }; // [promotionPieceType]
 
-                    mNoisiesScores[i] = -GOOD_SCORE * 2 + UNDERPROMO_BONUS[(int)promotion];
+                    score = -GOOD_SCORE * 2 + UNDERPROMO_BONUS[(int)promotion];
                 }
                 else {
                     const int pt = int(move.pieceType());
                     const i32 noisyHist = historyTable[stm][pt][move.to()].noisyHistory(captured, promotion);
 
-                    mNoisiesScores[i] = board.SEE(move, -noisyHist * seeNoisyHistMul()) ? GOOD_SCORE : -GOOD_SCORE;
+                    score = board.SEE(move, -noisyHist * seeNoisyHistMul()) ? GOOD_SCORE : -GOOD_SCORE;
                 }
 
                 // MVVLVA (most valuable victim, least valuable attacker)
                 if (captured != PieceType::NONE)
-                    mNoisiesScores[i] += 1000 + 100 * (i32)captured - i32(move.pieceType());
+                    score += 1000 + 100 * (i32)captured - i32(move.pieceType());
 
-                i++;
+                mMoves.push_back(scoredMoveKey(move, score));
             }
 
+            mNoisiesEnd = mMoves.size();
+
             mStage = MoveGenStage::GOOD_NOISIES;
             break;
         }
         case MoveGenStage::GOOD_NOISIES:
         {
-            while (++mNoisiesIdx < int(mNoisies.size()))
+            while (++mNoisiesIdx < mNoisiesEnd)
             {
-                move = partialSelectionSort(mNoisies, mNoisiesScores, mNoisiesIdx);
+                move = partialSelectionSort(mMoves, mNoisiesIdx, mNoisiesEnd);
 
                 if (moveScore() < GOOD_SCORE) {
                     mBadNoisyReady = true;
@@ -175,41 +190,41 @@ struct MovePicker {
         }
         case MoveGenStage::GEN_SCORE_QUIETS:
         {
+            PROFILE_SCOPE(ProfilePhase::GEN_SCORE_QUIETS);
+
             // Generate pseudolegal quiet moves (promotions excluded)
-            board.pseudolegalMoves(mQuiets, MoveGenType::QUIETS);
+            ArrayVec<Move, 256> quiets;
+            board.pseudolegalMoves(quiets, MoveGenType::QUIETS);
 
-            const Color nstm = board.oppSide();
+            // Enemy attacks are computed once and cached in the board state
+            const u64 enemyAttacks = board.attacks(board.oppSide());
 
-            const std::array<Move, 3> lastMoves = {
+            // Weights and continuation history indexes are the same for every quiet of this node
+            const QuietHistoryWeights weights = QuietHistoryWeights({
                 board.lastMove(), board.nthToLastMove(2), board.nthToLastMove(4)
-            };
+            });
 
             // Score moves
-            size_t j = 0;
-            while (j < mQuiets.size())
+            for (const Move move : quiets)
             {
-                move = mQuiets[j];
                 assert(board.isQuiet(move));
 
-                // Remove TT move and killer move and excluded move from list
+                // Skip TT move and killer move and excluded move
                 if (move == ttMove || move == killer || move == excludedMove)
-                {
-                    mQuiets.swap(j, mQuiets.size() - 1);
-                    mQuiets.pop_back();
                     continue;
-                }
 
                 const int pt = int(move.pieceType());
 
-                mQuietsScores[j] = historyTable[stm][pt][move.to()].quietHistory(
-                    board.isSquareAttacked(move.from(), nstm),
-                    board.isSquareAttacked(move.to(),   nstm),
-                    lastMoves
+                const i32 score = historyTable[stm][pt][move.to()].quietHistory(
+                    enemyAttacks & bitboard(move.from()),
+                    enemyAttacks & bitboard(move.to()),
+                    weights
                 );
 
-                j++;
+                mMoves.push_back(scoredMoveKey(move, score));
             }
 
+            mQuietsIdx = mNoisiesEnd - 1;
             mStage = MoveGenStage::QUIETS;
             break;
         }
@@ -217,9 +232,9 @@ struct MovePicker {
         {
             move = MOVE_NONE;
 
-            while (++mQuietsIdx < int(mQuiets.size()))
+            while (++mQuietsIdx < int(mMoves.size()))
             {
-                move = partialSelectionSort(mQuiets, mQuietsScores, mQuietsIdx);
+                move = partialSelectionSort(mMoves, mQuietsIdx, mMoves.size());
 
                 if (board.isPseudolegalLegal(move))
                     return move;
@@ -234,15 +249,17 @@ struct MovePicker {
                 assert(moveScore() < GOOD_SCORE);
                 mBadNoisyReady = false;
 
-                if (board.isPseudolegalLegal(mNoisies[mNoisiesIdx]))
-                    return mNoisies[mNoisiesIdx];
+                move = keyMove(mMoves[mNoisiesIdx]);
+
+                if (board.isPseudolegalLegal(move))
+                    return move;
             }
 
             move = MOVE_NONE;
 
-            while (++mNoisiesIdx < int(mNoisies.size()))
+            while (++mNoisiesIdx < mNoisiesEnd)
             {
-                move = partialSelectionSort(mNoisies, mNoisiesScores, mNoisiesIdx);
+                move = partialSelectionSort(mMoves, mNoisiesIdx, mNoisiesEnd);
                 assert(moveScore() < GOOD_SCORE);
 
                 if (board.isPseudolegalLegal(move))
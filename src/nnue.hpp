@@ -132,6 +132,26 @@ struct BothAccumulators {
         mUpdated = true;
     }
 
+    // Same as BothAccumulators(board), but each color's accumulator is computed
+    // from the finny table entry of its input bucket and mirroring, only adding/removing
+    // the pieces that differ, which is much faster for similar positions
+    inline BothAccumulators(const Board &board, FinnyTable &finnyTable)
+    {
+        for (const Color color : {Color::WHITE, Color::BLACK})
+        {
+            const File kingFile = squareFile(board.kingSquare(color));
+            mMirrorHorizontally[(int)color] = (int)kingFile >= (int)File::E;
+        }
+
+        setInputBucket(Color::WHITE, board.getBb(Color::BLACK, PieceType::QUEEN));
+        setInputBucket(Color::BLACK, board.getBb(Color::WHITE, PieceType::QUEEN));
+
+        updateFinnyEntryAndAccumulator(finnyTable, Color::WHITE, board);
+        updateFinnyEntryAndAccumulator(finnyTable, Color::BLACK, board);
+
+        mUpdated = true;
+    }
+
     private:
 
     constexpr int setInputBucket(const Color color, const u64 enemyQueensBb)
@@ -160,6 +180,8 @@ struct BothAccumulators {
         return (int)pieceColor * 384 + (int)pt * 64 + (int)sq;
     }
 
+    public:
+
     constexpr void updateFinnyEntryAndAccumulator(FinnyTable &finnyTable, const Color accColor, const Board &board)
     {
         const int iAccColor = (int)accColor;
@@ -203,8 +225,6 @@ struct BothAccumulators {
         board.getPiecesBitboards(finnyEntry.piecesBitboards);
     }
 
-    public:
-
     constexpr void update(BothAccumulators* prevBothAccs, const Board &board, FinnyTable &finnyTable)
     {
         assert(prevBothAccs->mUpdated && !mUpdated);
@@ -304,8 +324,23 @@ struct BothAccumulators {
 
 }; // struct BothAccumulators
 
+// Empties every entry (no pieces, accumulator = biases)
+inline void resetFinnyTable(FinnyTable &finnyTable)
+{
+    for (int color = 0; color < 2; color++)
+        for (auto &mirrorEntries : finnyTable[color])
+            for (FinnyTableEntry &finnyEntry : mirrorEntries)
+            {
+                finnyEntry.accumulator = NET->hiddenBiases[color];
+                finnyEntry.colorBitboards  = { };
+                finnyEntry.piecesBitboards = { };
+            }
+}
+
 constexpr i32 evaluate(const BothAccumulators* bothAccs, const Color sideToMove)
 {
+    PROFILE_SCOPE(ProfilePhase::NNUE_EVALUATE);
+
     assert(bothAccs->mUpdated);
 
     const int stm = (int)sideToMove;
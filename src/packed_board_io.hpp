@@ -0,0 +1,138 @@
+// clang-format off
+
+#pragma once
+
+#include "utils.hpp"
+#include "board.hpp"
+#include <fstream>
+
+// Buffered streaming of files of PackedBoard records
+
+constexpr size_t PACKED_IO_BUFFER_RECORDS = 16384; // 512 KB
+
+// Files ending in .bin are PackedBoard records, anything else is FEN lines
+inline bool isPackedFile(const std::string &path)
+{
+    return path.size() >= 4 && path.substr(path.size() - 4) == ".bin";
+}
+
+class PackedBoardWriter {
+    private:
+
+    std::ofstream mFile;
+    std::vector<PackedBoard> mBuffer = { };
+    u64 mRecordsWritten = 0;
+
+    public:
+
+    inline PackedBoardWriter(const std::string &path, const bool append = false)
+        : mFile(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc))
+    {
+        mBuffer.reserve(PACKED_IO_BUFFER_RECORDS);
+    }
+
+    inline ~PackedBoardWriter() { flush(); }
+
+    PackedBoardWriter(const PackedBoardWriter&) = delete;
+    PackedBoardWriter& operator=(const PackedBoardWriter&) = delete;
+
+    inline bool isOpen() const { return mFile.is_open() && mFile.good(); }
+
+    inline u64 recordsWritten() const { return mRecordsWritten; }
+
+    inline void write(const PackedBoard &packed)
+    {
+        mBuffer.push_back(packed);
+        mRecordsWritten++;
+
+        if (mBuffer.size() >= PACKED_IO_BUFFER_RECORDS)
+            flush();
+    }
+
+    inline void write(const std::vector<PackedBoard> &packedBoards)
+    {
+        for (const PackedBoard &packed : packedBoards)
+            write(packed);
+    }
+
+    inline void flush()
+    {
+        if (!mBuffer.empty())
+            mFile.write(reinterpret_cast<const char*>(mBuffer.data()), mBuffer.size() * sizeof(PackedBoard));
+
+        mBuffer.clear();
+        mFile.flush();
+    }
+
+}; // class PackedBoardWriter
+
+class PackedBoardReader {
+    private:
+
+    std::ifstream mFile;
+    std::vector<PackedBoard> mBuffer = { };
+    size_t mBufferIdx = 0;
+    u64 mInvalidRecords = 0;
+
+    public:
+
+    inline PackedBoardReader(const std::string &path)
+        : mFile(path, std::ios::binary)
+    {
+        mBuffer.reserve(PACKED_IO_BUFFER_RECORDS);
+    }
+
+    PackedBoardReader(const PackedBoardReader&) = delete;
+    PackedBoardReader& operator=(const PackedBoardReader&) = delete;
+
+    inline bool isOpen() const { return mFile.is_open(); }
+
+    // Records skipped so far because they failed PackedBoard::isValid()
+    inline u64 invalidRecords() const { return mInvalidRecords; }
+
+    // Reads the next valid record, skipping and counting invalid ones
+    // Returns false at end of file
+    inline bool next(PackedBoard &packed)
+    {
+        while (true) {
+            if (mBufferIdx >= mBuffer.size() && !refill())
+                return false;
+
+            packed = mBuffer[mBufferIdx++];
+
+            if (packed.isValid()) return true;
+
+            mInvalidRecords++;
+        }
+    }
+
+    // Appends up to maxRecords records to packedBoards and returns how many were read
+    inline size_t read(std::vector<PackedBoard> &packedBoards, const size_t maxRecords)
+    {
+        size_t numRead = 0;
+        PackedBoard packed;
+
+        while (numRead < maxRecords && next(packed))
+        {
+            packedBoards.push_back(packed);
+            numRead++;
+        }
+
+        return numRead;
+    }
+
+    private:
+
+    inline bool refill()
+    {
+        mBuffer.resize(PACKED_IO_BUFFER_RECORDS);
+        mFile.read(reinterpret_cast<char*>(mBuffer.data()), mBuffer.size() * sizeof(PackedBoard));
+
+        // A trailing partial record is ignored
+        mBuffer.resize(size_t(mFile.gcount()) / sizeof(PackedBoard));
+        mBufferIdx = 0;
+
+        return !mBuffer.empty();
+    }
+
+}; // class PackedBoardReader
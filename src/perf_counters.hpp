@@ -0,0 +1,143 @@
+// clang-format off
+
+#pragma once
+
+#include "utils.hpp"
+
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #include <cerrno>
+    #include <cstring>
+#endif
+
+// Hardware performance counters of this process (Linux only)
+// Threads created after construction are also counted
+// If a counter can't be opened (not Linux, no permission, not supported by the CPU or VM),
+// it is reported as unavailable and everything else still works
+class PerfCounters {
+    private:
+
+    static constexpr size_t NUM_COUNTERS = 6;
+
+    static constexpr std::array<const char*, NUM_COUNTERS> COUNTERS_NAMES = {
+        "cycles", "instructions", "L1d misses", "LLC misses", "dTLB misses", "branch misses"
+    };
+
+    std::array<int, NUM_COUNTERS> mFds;
+    std::array<u64, NUM_COUNTERS> mValues = { };
+    std::string mError = "";
+
+    public:
+
+    inline PerfCounters()
+    {
+        mFds.fill(-1);
+
+        #if defined(__linux__)
+            const auto cacheConfig = [](const u64 cache) constexpr -> u64 {
+                return cache
+                       | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                       | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            };
+
+            const std::array<std::pair<u32, u64>, NUM_COUNTERS> typesConfigs = {
+                std::pair { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+                std::pair { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+                std::pair { PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_L1D) },
+                std::pair { PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_LL) },
+                std::pair { PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_DTLB) },
+                std::pair { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+            };
+
+            for (size_t i = 0; i < NUM_COUNTERS; i++)
+            {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+
+                attr.size = sizeof(attr);
+                attr.type = typesConfigs[i].first;
+                attr.config = typesConfigs[i].second;
+                attr.disabled = 1;
+                attr.inherit = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                mFds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+
+                if (mFds[i] < 0 && mError == "")
+                    mError = std::string(COUNTERS_NAMES[i]) + ": " + std::strerror(errno);
+            }
+        #else
+            mError = "perf counters are only supported on Linux";
+        #endif
+    }
+
+    inline ~PerfCounters()
+    {
+        #if defined(__linux__)
+            for (const int fd : mFds)
+                if (fd >= 0) close(fd);
+        #endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    inline void start()
+    {
+        #if defined(__linux__)
+            for (const int fd : mFds)
+                if (fd >= 0) {
+                    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                }
+        #endif
+    }
+
+    inline void stop()
+    {
+        #if defined(__linux__)
+            for (size_t i = 0; i < NUM_COUNTERS; i++)
+            {
+                if (mFds[i] < 0) continue;
+
+                ioctl(mFds[i], PERF_EVENT_IOC_DISABLE, 0);
+
+                // [value, time enabled, time running]
+                std::array<u64, 3> data = { };
+
+                if (read(mFds[i], data.data(), sizeof(data)) != (ssize_t)sizeof(data))
+                    continue;
+
+                // If the counter was multiplexed with others, scale it to the whole time
+                mValues[i] = data[2] > 0 ? (double)data[0] * (double)data[1] / (double)data[2] : 0;
+            }
+        #endif
+    }
+
+    // Prints the counters of the last start() - stop() as info strings
+    inline void print(const u64 nodes) const
+    {
+        if (mError != "")
+            std::cout << "info string perf counters unavailable (" << mError << ")" << std::endl;
+
+        const auto available = [&](const size_t i) { return mFds[i] >= 0; };
+
+        if (available(0) && available(1))
+            std::cout << "info string perf ipc "
+                      << (double)mValues[1] / std::max<double>(mValues[0], 1.0)
+                      << std::endl;
+
+        for (size_t i = 0; i < NUM_COUNTERS; i++)
+            if (available(i))
+                std::cout << "info string perf " << COUNTERS_NAMES[i]
+                          << " " << mValues[i]
+                          << " per node " << (double)mValues[i] / std::max<double>(nodes, 1.0)
+                          << std::endl;
+    }
+
+}; // class PerfCounters
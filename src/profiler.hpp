@@ -0,0 +1,134 @@
+// clang-format off
+
+#pragma once
+
+#include "utils.hpp"
+
+// Search phases profiler
+// Compile with -DPROFILE ("make profile") to time search phases with rdtsc
+// Without PROFILE, PROFILE_SCOPE() expands to nothing
+
+enum class ProfilePhase : int {
+    TT_PROBE,
+    UPDATE_ACC_AND_EVAL,
+    NNUE_EVALUATE,
+    GEN_SCORE_NOISIES,
+    GEN_SCORE_QUIETS,
+    SEE,
+    MAKE_MOVE,
+    UPCOMING_REPETITION,
+    COUNT
+};
+
+#if defined(PROFILE)
+
+#include <x86intrin.h>
+#include <mutex>
+#include <iomanip>
+
+constexpr std::array<const char*, (size_t)ProfilePhase::COUNT> PROFILE_PHASES_NAMES = {
+    "TT probe",
+    "updateAccumulatorAndEval",
+    "  nnue::evaluate",
+    "gen/score noisies",
+    "gen/score quiets",
+    "SEE",
+    "makeMove",
+    "hasUpcomingRepetition"
+};
+
+struct PhaseStats {
+    public:
+    u64 cycles = 0;
+    u64 calls = 0;
+};
+
+using ProfileStats = std::array<PhaseStats, (size_t)ProfilePhase::COUNT>; // [phase]
+
+// Every thread only writes to its own stats, so timing is lock free
+// The mutex is only taken once per thread, to register its stats
+inline std::mutex gProfileMutex;
+inline std::vector<ProfileStats*> gThreadsProfileStats = { };
+
+inline ProfileStats& threadProfileStats()
+{
+    thread_local ProfileStats* stats = []() {
+        ProfileStats* newStats = new ProfileStats();
+        std::lock_guard<std::mutex> lock(gProfileMutex);
+        gThreadsProfileStats.push_back(newStats);
+        return newStats;
+    }();
+
+    return *stats;
+}
+
+// Adds the cycles from construction to destruction to the phase's stats
+// constexpr (doing nothing at compile time) so that it can be used in constexpr functions
+struct ProfileScope {
+    private:
+    ProfilePhase mPhase;
+    u64 mStartCycles = 0;
+
+    public:
+
+    constexpr ProfileScope(const ProfilePhase phase) : mPhase(phase)
+    {
+        if !consteval {
+            mStartCycles = __rdtsc();
+        }
+    }
+
+    constexpr ~ProfileScope()
+    {
+        if !consteval {
+            PhaseStats &phaseStats = threadProfileStats()[(size_t)mPhase];
+            phaseStats.cycles += __rdtsc() - mStartCycles;
+            phaseStats.calls++;
+        }
+    }
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(phase) const ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(phase)
+
+// Only call these while no thread is searching
+
+inline void profileReset()
+{
+    std::lock_guard<std::mutex> lock(gProfileMutex);
+
+    for (ProfileStats* stats : gThreadsProfileStats)
+        *stats = ProfileStats();
+}
+
+inline void profilePrint(const u64 nodes)
+{
+    std::lock_guard<std::mutex> lock(gProfileMutex);
+
+    ProfileStats total = ProfileStats();
+
+    for (const ProfileStats* stats : gThreadsProfileStats)
+        for (size_t phase = 0; phase < total.size(); phase++)
+        {
+            total[phase].cycles += (*stats)[phase].cycles;
+            total[phase].calls  += (*stats)[phase].calls;
+        }
+
+    std::cout << "info string profile (inclusive cycles, nested phases are indented, SEE includes move picker calls) nodes " << nodes << std::endl;
+
+    for (size_t phase = 0; phase < total.size(); phase++)
+        std::cout << "info string profile "
+                  << std::left << std::setw(26) << PROFILE_PHASES_NAMES[phase] << std::right
+                  << " calls "           << total[phase].calls
+                  << " cycles "          << total[phase].cycles
+                  << " cycles/call "     << total[phase].cycles / std::max<u64>(total[phase].calls, 1)
+                  << " cycles/node "     << total[phase].cycles / std::max<u64>(nodes, 1)
+                  << std::endl;
+}
+
+#else
+
+#define PROFILE_SCOPE(phase)
+
+#endif
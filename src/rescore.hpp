@@ -0,0 +1,221 @@
+// clang-format off
+
+#pragma once
+
+#include "utils.hpp"
+#include "board.hpp"
+#include "search.hpp"
+#include "packed_board_io.hpp"
+#include <fstream>
+#include <barrier>
+#include <memory>
+
+// Dataset rescoring: relabels positions with the score of a fixed depth or nodes search
+
+// Positions are processed in chunks of this * threads, which bounds memory
+// and keeps the output in input order
+constexpr size_t RESCORE_CHUNK_POSITIONS_PER_THREAD = 256;
+
+struct RescoreJob {
+    public:
+    PackedBoard packed = PackedBoard();
+
+    // FEN line input: the line, and the output line
+    // Lines are "<fen>", "<fen> | <score>" or "<fen> | <score> | <more fields>"
+    // The score is replaced (or added) and other fields are kept
+    std::string line = "";
+};
+
+// Writes the search score from white's perspective into the job
+inline void rescoreJob(RescoreJob &job, Searcher &searcher, const i32 depth, const u64 nodes)
+{
+    const bool isFen = job.line != "";
+
+    std::string fen = "", otherFields = "";
+
+    if (isFen) {
+        const size_t scoreStart = job.line.find('|');
+        fen = job.line.substr(0, scoreStart);
+        trim(fen);
+
+        if (scoreStart != std::string::npos)
+        {
+            const size_t otherFieldsStart = job.line.find('|', scoreStart + 1);
+
+            if (otherFieldsStart != std::string::npos)
+                otherFields = job.line.substr(otherFieldsStart);
+        }
+
+        searcher.board() = Board(fen);
+    }
+    else
+        searcher.board() = Board(job.packed);
+
+    const Color stm = searcher.board().sideToMove();
+
+    const i32 score = searcher.searchSync(depth, nodes).second;
+
+    const i32 whiteScore = std::clamp<i32>(stm == Color::WHITE ? score : -score, -32767, 32767);
+
+    if (isFen)
+        job.line = fen + " | " + std::to_string(whiteScore) + (otherFields != "" ? " " + otherFields : "");
+    else
+        job.packed.score = whiteScore;
+}
+
+// Streams inFile through numThreads workers, each with its own single-threaded Searcher and TT,
+// and writes the positions with new scores to outFile, in the same order and format
+// TT and histories of a worker are kept between its positions
+inline void rescore(
+    const std::string &inFile,
+    const std::string &outFile,
+    const int numThreads,
+    const i32 depth,
+    const u64 nodes,
+    const i64 hashMB)
+{
+    const bool packed = isPackedFile(inFile);
+
+    if (packed != isPackedFile(outFile)) {
+        std::cout << "info string Input and output must both be .bin or both be FEN lines" << std::endl;
+        return;
+    }
+
+    std::ifstream fenIn;
+    std::ofstream fenOut;
+    std::unique_ptr<PackedBoardReader> packedIn = nullptr;
+    std::unique_ptr<PackedBoardWriter> packedOut = nullptr;
+
+    if (packed) {
+        packedIn  = std::make_unique<PackedBoardReader>(inFile);
+        packedOut = std::make_unique<PackedBoardWriter>(outFile);
+    }
+    else {
+        fenIn.open(inFile);
+        fenOut.open(outFile);
+    }
+
+    if (packed ? !packedIn->isOpen() : !fenIn.is_open()) {
+        std::cout << "info string Failed to open " << inFile << std::endl;
+        return;
+    }
+
+    if (packed ? !packedOut->isOpen() : !fenOut.is_open()) {
+        std::cout << "info string Failed to open " << outFile << std::endl;
+        return;
+    }
+
+    std::cout << "rescore input " << inFile
+              << " output "       << outFile
+              << " threads "      << numThreads
+              << " depth "        << depth
+              << " nodes "        << (nodes >= std::numeric_limits<i64>::max() ? "none" : std::to_string(nodes))
+              << " hash "         << hashMB << " MB"
+              << std::endl;
+
+    const std::chrono::time_point<std::chrono::steady_clock> startTime = std::chrono::steady_clock::now();
+
+    const size_t chunkSize = RESCORE_CHUNK_POSITIONS_PER_THREAD * size_t(numThreads);
+
+    std::vector<RescoreJob> chunk = { };
+    chunk.reserve(chunkSize);
+
+    std::atomic<size_t> nextJobIdx = 0;
+    bool done = false;
+    u64 positionsWritten = 0, linesRead = 0, invalidLines = 0;
+
+    // Runs on one thread when all workers finished the current chunk:
+    // writes it and reads the next one
+    const auto onChunkDone = [&]() noexcept
+    {
+        for (const RescoreJob &job : chunk)
+            if (packed)
+                packedOut->write(job.packed);
+            else
+                fenOut << job.line << "\n";
+
+        positionsWritten += chunk.size();
+
+        if (!chunk.empty()) {
+            const u64 ms = std::max<u64>(millisecondsElapsed(startTime), 1);
+
+            std::cout << "positions "       << positionsWritten
+                      << " positions/sec "  << positionsWritten * 1000 / ms
+                      << " time "           << ms
+                      << std::endl;
+        }
+
+        chunk.clear();
+
+        if (packed) {
+            std::vector<PackedBoard> packedBoards = { };
+            packedIn->read(packedBoards, chunkSize);
+
+            for (const PackedBoard &packedBoard : packedBoards)
+                chunk.push_back(RescoreJob { packedBoard, "" });
+        }
+        else {
+            std::string line;
+
+            while (chunk.size() < chunkSize && std::getline(fenIn, line))
+            {
+                linesRead++;
+                trim(line);
+
+                if (line == "") continue;
+
+                std::string fen = line.substr(0, line.find('|'));
+                trim(fen);
+
+                if (!isValidFen(fen)) {
+                    std::cout << "info string Skipping invalid FEN on line " << linesRead << ": " << line << std::endl;
+                    invalidLines++;
+                    continue;
+                }
+
+                chunk.push_back(RescoreJob { PackedBoard(), line });
+            }
+        }
+
+        nextJobIdx = 0;
+        done = chunk.empty();
+    };
+
+    std::barrier chunkBarrier(numThreads, onChunkDone);
+
+    const auto worker = [&]()
+    {
+        Searcher searcher = Searcher(false);
+        resizeTT(searcher.mTT, hashMB);
+
+        while (true) {
+            chunkBarrier.arrive_and_wait();
+
+            if (done) break;
+
+            for (size_t i = nextJobIdx.fetch_add(1); i < chunk.size(); i = nextJobIdx.fetch_add(1))
+                rescoreJob(chunk[i], searcher, depth, nodes);
+        }
+    };
+
+    std::vector<std::thread> threads = { };
+
+    for (int i = 0; i < numThreads; i++)
+        threads.push_back(std::thread(worker));
+
+    for (std::thread &thread : threads)
+        thread.join();
+
+    if (packed)
+        packedOut->flush();
+    else
+        fenOut.flush();
+
+    std::cout << "rescore finished, wrote " << positionsWritten
+              << " positions to " << outFile;
+
+    if (packed)
+        std::cout << ", skipped " << packedIn->invalidRecords() << " invalid records" << std::endl;
+    else
+        std::cout << ", skipped " << invalidLines << " invalid FEN lines" << std::endl;
+}
@@ -9,8 +9,41 @@
 #include "history_entry.hpp"
 #include "tt.hpp"
 #include "nnue.hpp"
+#include "time_manager.hpp"
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Node types are compile time so that each one only carries its own logic
+// SINGULAR is a non-PV node searched with the TT move excluded
+enum class NodeType {
+    ROOT, PV, NON_PV, SINGULAR
+};
+
+// Main thread's info after each completed iteration, see Searcher::setIterationCallback()
+struct SearchInfo {
+    public:
+    i32 depth = 0;
+    i32 seldepth = 0;
+    i32 score = 0;
+    u64 nodes = 0;
+    u64 milliseconds = 0;
+    ArrayVec<Move, MAX_DEPTH+1> pvLine = { };
+};
+
+// Result of one position's search in Searcher::analyze()
+struct AnalysisResult {
+    public:
+    u64 index = 0; // in order of positions given
+    PackedBoard position = PackedBoard();
+    i32 depth = 0; // completed depth
+    i32 score = 0;
+    ArrayVec<Move, MAX_DEPTH+1> pvLine = { };
+    u64 nodes = 0;
+    u64 milliseconds = 0;
+};
 
 class Searcher {
     private:
@@ -24,16 +57,43 @@ class Searcher {
     std::chrono::time_point<std::chrono::steady_clock> mStartTime = std::chrono::steady_clock::now();
     u64 mHardMs = std::numeric_limits<u64>::max();
     u64 mSoftMs = std::numeric_limits<u64>::max();
+    u64 mSoftNodes = std::numeric_limits<u64>::max();
 
     bool mPrintInfo = true;
 
+    // If set, called by the main thread after each completed iteration, independently of mPrintInfo
+    std::function<void(const SearchInfo&)> mOnIteration = nullptr;
+
     std::atomic<bool> mStopSearch = false;
 
+    // When main thread decided to stop searching
+    std::chrono::time_point<std::chrono::steady_clock> mStopTime = std::chrono::steady_clock::now();
+
+    // Sleeps until the hard time limit and then sets mHardTimeUp,
+    // so the search doesn't have to read the clock
+    std::thread mTimerThread;
+    std::mutex mTimerMutex;
+    std::condition_variable mTimerCv;
+    bool mTimerCancelled = false;
+    std::atomic<bool> mHardTimeUp = false;
+
+    // analyze(): each thread searches its own positions, sharing the TT
+    bool mIndependentSearches = false;
+    std::mutex mAnalyzeMutex;
+    std::function<bool(PackedBoard&)> mNextPosition;
+    std::function<void(const AnalysisResult&)> mOnAnalysisResult;
+    u64 mNextPositionIdx = 0;
+
+    // If false, there are no native threads and only searchSync() can search
+    bool mThreadPool = true;
+
     public:
 
     std::vector<TTEntry> mTT = { }; // Transposition table
 
-    inline Searcher() {
+    // threadPool = false for a single-threaded searcher that only searches in the calling thread
+    // with searchSync(), e.g. one per datagen/rescore worker
+    inline Searcher(const bool threadPool = true) : mThreadPool(threadPool) {
         resizeTT(mTT, 32);
         setThreads(1);
     }
@@ -67,6 +127,26 @@ class Searcher {
                : MOVE_NONE;
     }
 
+    constexpr auto stopTime() const { return mStopTime; }
+
+    constexpr i32 completedDepth() const { return mainThreadData()->completedDepth; }
+
+    // nullptr to remove it
+    inline void setIterationCallback(const std::function<void(const SearchInfo&)> onIteration) {
+        mOnIteration = onIteration;
+    }
+
+    // Search stats of the last search, summed over all threads
+    inline void printStats() const
+    {
+        SearchStats stats = mainThreadData()->stats;
+
+        for (size_t i = 1; i < mThreadsData.size(); i++)
+            stats += mThreadsData[i]->stats;
+
+        stats.print(totalNodes(), completedDepth());
+    }
+
     constexpr u64 totalNodes() const
     {
         u64 nodes = 0;
@@ -89,6 +169,8 @@ class Searcher {
 
             if (td->threadState == ThreadState::SEARCHING)
                 iterativeDeepening(*td);
+            else if (td->threadState == ThreadState::ANALYZING)
+                analyzeLoop(*td);
             else if (td->threadState == ThreadState::EXIT_ASAP)
                 break;
 
@@ -115,7 +197,7 @@ class Searcher {
 
     inline int setThreads(int numThreads)
     {
-        numThreads = std::clamp(numThreads, 0, 256);
+        numThreads = std::clamp(numThreads, 0, mThreadPool ? 256 : 1);
 
         blockUntilSleep();
 
@@ -126,20 +208,24 @@ class Searcher {
         {
             ThreadData* lastThreadData = mThreadsData.back();
 
-            lastThreadData->wake(ThreadState::EXIT_ASAP);
-
+            if (mThreadPool)
             {
-                std::unique_lock<std::mutex> lock(lastThreadData->mutex);
+                lastThreadData->wake(ThreadState::EXIT_ASAP);
 
-                lastThreadData->cv.wait(lock, [lastThreadData] {
-                    return lastThreadData->threadState == ThreadState::EXITED;
-                });
-            }
+                {
+                    std::unique_lock<std::mutex> lock(lastThreadData->mutex);
+
+                    lastThreadData->cv.wait(lock, [lastThreadData] {
+                        return lastThreadData->threadState == ThreadState::EXITED;
+                    });
+                }
 
-            if (mNativeThreads.back().joinable())
-                mNativeThreads.back().join();
+                if (mNativeThreads.back().joinable())
+                    mNativeThreads.back().join();
+
+                mNativeThreads.pop_back();
+            }
 
-            mNativeThreads.pop_back();
             delete lastThreadData, mThreadsData.pop_back();
         }
 
@@ -150,10 +236,12 @@ class Searcher {
         while (int(mThreadsData.size()) < numThreads)
         {
             ThreadData* threadData = new ThreadData();
-            std::thread nativeThread([=, this]() mutable { loop(threadData); });
-
+            threadData->threadIdx = mThreadsData.size();
+            nnue::resetFinnyTable(threadData->finnyTable);
             mThreadsData.push_back(threadData);
-            mNativeThreads.push_back(std::move(nativeThread));
+
+            if (mThreadPool)
+                mNativeThreads.push_back(std::thread([=, this]() mutable { loop(threadData); }));
         }
 
         mThreadsData.shrink_to_fit();
@@ -171,42 +259,28 @@ class Searcher {
         const std::chrono::time_point<std::chrono::steady_clock> startTime,
         const u64 hardMs,
         const u64 softMs,
-        const bool printInfo)
+        const bool printInfo,
+        const u64 softNodes = std::numeric_limits<u64>::max())
     {
+        assert(mThreadPool);
+
         mMaxDepth = std::clamp(maxDepth, 1, MAX_DEPTH);
         mMaxNodes = maxNodes;
         mStartTime = startTime;
         mHardMs = hardMs;
         mSoftMs = softMs;
+        mSoftNodes = softNodes;
 
         mPrintInfo = printInfo;
         mStopSearch = false;
+        mHardTimeUp = false;
 
         blockUntilSleep();
 
         mainThreadData()->nodes = 0;
         mainThreadData()->accumulators[0] = BothAccumulators(mainThreadData()->board);
 
-        // Init main thread's finny table
-        for (const int color : {WHITE, BLACK})
-            for (const int mirrorHorizontally : {false, true})
-                for (int inputBucket = 0; inputBucket < nnue::NUM_INPUT_BUCKETS; inputBucket++)
-                {
-                    FinnyTableEntry &finnyEntry = mainThreadData()->finnyTable[color][mirrorHorizontally][inputBucket];
-
-                    if (mirrorHorizontally == mainThreadData()->accumulators[0].mMirrorHorizontally[color]
-                    && inputBucket == mainThreadData()->accumulators[0].mInputBucket[color])
-                    {
-                        finnyEntry.accumulator = mainThreadData()->accumulators[0].mAccumulators[color];
-                        mainThreadData()->board.getColorBitboards(finnyEntry.colorBitboards);
-                        mainThreadData()->board.getPiecesBitboards(finnyEntry.piecesBitboards);
-                    }
-                    else {
-                        finnyEntry.accumulator = nnue::NET->hiddenBiases[color];
-                        finnyEntry.colorBitboards  = { };
-                        finnyEntry.piecesBitboards = { };
-                    }
-                }
+        initFinnyTable(*mainThreadData());
 
         // Init auxiliar threads
         for (size_t i = 1; i < mThreadsData.size(); i++)
@@ -220,107 +294,423 @@ class Searcher {
         for (ThreadData* td : mThreadsData)
         {
             td->nodesByMove = { };
+            td->stopSearch = false;
+
+            #if defined(SEARCH_STATS)
+                td->stats = SearchStats();
+            #endif
+
             td->pliesData[0] = PlyData();
             td->accumulatorPtr = &(td->accumulators[0]);
             td->wake(ThreadState::SEARCHING);
         }
 
+        startTimer();
         blockUntilSleep();
+        stopTimer();
 
-        return { bestMoveRoot(), mainThreadData()->score };
+        const ThreadData* bestThreadData = votedBestThreadData();
+
+        // If a helper thread was voted, report its iteration last,
+        // so that the last info and iteration callback match bestmove
+        if (bestThreadData != mainThreadData())
+            reportIteration(*bestThreadData, millisecondsElapsed(mStartTime));
+
+        return { threadBestMove(bestThreadData), bestThreadData->score };
+    }
+
+    // For many short depth/nodes limited searches (datagen, rescoring)
+    // If single-threaded, searches in the calling thread, skipping the thread wake/sleep hand-off,
+    // the nodesByMove reset (only used by the soft time limit) and the finny table reinit
+    // (its entries are always valid, so the root accumulator is built from it)
+    // Otherwise, same as search() without time limits
+    inline std::pair<Move, i32> searchSync(
+        const i32 maxDepth,
+        const u64 maxNodes,
+        const u64 softNodes = std::numeric_limits<u64>::max())
+    {
+        const std::chrono::time_point<std::chrono::steady_clock> startTime = std::chrono::steady_clock::now();
+        constexpr u64 NO_LIMIT = std::numeric_limits<i64>::max();
+
+        if (mThreadsData.size() > 1)
+            return search(maxDepth, maxNodes, startTime, NO_LIMIT, NO_LIMIT, false, softNodes);
+
+        mMaxDepth = std::clamp(maxDepth, 1, MAX_DEPTH);
+        mMaxNodes = maxNodes;
+        mStartTime = startTime;
+        mHardMs = mSoftMs = NO_LIMIT;
+        mSoftNodes = softNodes;
+
+        mPrintInfo = false;
+        mStopSearch = false;
+        mHardTimeUp = false;
+
+        blockUntilSleep();
+
+        ThreadData &td = *mainThreadData();
+
+        td.nodes = 0;
+        td.stopSearch = false;
+
+        #if defined(SEARCH_STATS)
+            td.stats = SearchStats();
+        #endif
+
+        td.pliesData[0] = PlyData();
+        td.accumulators[0] = BothAccumulators(td.board, td.finnyTable);
+        td.accumulatorPtr = &(td.accumulators[0]);
+
+        iterativeDeepening(td);
+
+        return { threadBestMove(&td), td.score };
+    }
+
+    // Searches many positions to a fixed depth and/or nodes, each thread searching its own position alone
+    // All threads share the TT, but each has its own histories, which are kept between positions
+    // nextPosition(position) returns false when there are no more positions
+    // nextPosition() and onResult() are called from the search threads, never concurrently
+    inline void analyze(
+        const i32 maxDepth,
+        const u64 maxNodes,
+        const std::function<bool(PackedBoard&)> nextPosition,
+        const std::function<void(const AnalysisResult&)> onResult)
+    {
+        assert(mThreadPool);
+
+        mMaxDepth = std::clamp(maxDepth, 1, MAX_DEPTH);
+        mMaxNodes = maxNodes;
+        mStartTime = std::chrono::steady_clock::now();
+        mHardMs = mSoftMs = mSoftNodes = std::numeric_limits<u64>::max();
+
+        mPrintInfo = false;
+        mStopSearch = false;
+        mHardTimeUp = false;
+
+        blockUntilSleep();
+
+        const Board board = mainThreadData()->board;
+
+        mIndependentSearches = true;
+        mNextPosition = nextPosition;
+        mOnAnalysisResult = onResult;
+        mNextPositionIdx = 0;
+
+        for (ThreadData* td : mThreadsData)
+            td->wake(ThreadState::ANALYZING);
+
+        blockUntilSleep();
+
+        mIndependentSearches = false;
+        mainThreadData()->board = board;
+        mainThreadData()->pliesData[0].pvLine.clear(); // reset best root move
     }
 
     private:
 
+    inline void analyzeLoop(ThreadData &td)
+    {
+        while (true) {
+            AnalysisResult result = AnalysisResult();
+
+            {
+                std::lock_guard<std::mutex> lock(mAnalyzeMutex);
+
+                if (!mNextPosition(result.position)) break;
+
+                result.index = mNextPositionIdx++;
+            }
+
+            const std::chrono::time_point<std::chrono::steady_clock> startTime = std::chrono::steady_clock::now();
+
+            td.board = Board(result.position);
+            td.nodes = 0;
+            td.stopSearch = false;
+
+            #if defined(SEARCH_STATS)
+                td.stats = SearchStats();
+            #endif
+
+            td.pliesData[0] = PlyData();
+            td.accumulators[0] = BothAccumulators(td.board);
+            td.accumulatorPtr = &(td.accumulators[0]);
+            initFinnyTable(td);
+
+            iterativeDeepening(td);
+
+            result.depth = td.completedDepth;
+            result.score = td.score;
+            result.pvLine = td.pliesData[0].pvLine;
+            result.nodes = td.nodes;
+            result.milliseconds = millisecondsElapsed(startTime);
+
+            std::lock_guard<std::mutex> lock(mAnalyzeMutex);
+            mOnAnalysisResult(result);
+        }
+    }
+
+    // The finny table entries of the thread's root accumulator are that accumulator,
+    // the other entries are empty
+    constexpr void initFinnyTable(ThreadData &td)
+    {
+        for (const int color : {WHITE, BLACK})
+            for (const int mirrorHorizontally : {false, true})
+                for (int inputBucket = 0; inputBucket < nnue::NUM_INPUT_BUCKETS; inputBucket++)
+                {
+                    FinnyTableEntry &finnyEntry = td.finnyTable[color][mirrorHorizontally][inputBucket];
+
+                    if (mirrorHorizontally == td.accumulators[0].mMirrorHorizontally[color]
+                    && inputBucket == td.accumulators[0].mInputBucket[color])
+                    {
+                        finnyEntry.accumulator = td.accumulators[0].mAccumulators[color];
+                        td.board.getColorBitboards(finnyEntry.colorBitboards);
+                        td.board.getPiecesBitboards(finnyEntry.piecesBitboards);
+                    }
+                    else {
+                        finnyEntry.accumulator = nnue::NET->hiddenBiases[color];
+                        finnyEntry.colorBitboards  = { };
+                        finnyEntry.piecesBitboards = { };
+                    }
+                }
+    }
+
+    // Whether the thread decides when its search stops
+    // (main thread, or every thread in analyze())
+    constexpr bool controlsSearch(const ThreadData &td) const
+    {
+        return mIndependentSearches || &td == mainThreadData();
+    }
+
+    // Nodes of the thread's search (all threads' nodes, except in analyze())
+    constexpr u64 searchNodes(const ThreadData &td) const
+    {
+        return mIndependentSearches ? td.nodes : totalNodes();
+    }
+
+    constexpr bool searchStopped(const ThreadData &td) const
+    {
+        return mStopSearch.load(std::memory_order_relaxed) || td.stopSearch;
+    }
+
+    constexpr bool stopSearch(ThreadData &td)
+    {
+        if (mIndependentSearches)
+            td.stopSearch = true;
+        else
+            mStopSearch = true;
+
+        return true;
+    }
+
+    constexpr static Move threadBestMove(const ThreadData* td)
+    {
+        return td->pliesData[0].pvLine.size() > 0 ? td->pliesData[0].pvLine[0] : MOVE_NONE;
+    }
+
+    // Lazy SMP: each thread votes for its best move, weighted by its score and completed depth
+    // Returns the thread whose best move has the most votes, or the one with the best mate score
+    constexpr const ThreadData* votedBestThreadData() const
+    {
+        const auto hasResult = [](const ThreadData* td) constexpr {
+            return td->completedDepth > 0 && threadBestMove(td) != MOVE_NONE;
+        };
+
+        const ThreadData* bestTd = mainThreadData();
+
+        if (mThreadsData.size() == 1 || !hasResult(bestTd))
+            return bestTd;
+
+        i32 minScore = INF;
+
+        for (const ThreadData* td : mThreadsData)
+            if (hasResult(td))
+                minScore = std::min(minScore, td->score);
+
+        const auto votes = [&](const Move move) constexpr -> i64
+        {
+            i64 total = 0;
+
+            for (const ThreadData* td : mThreadsData)
+                if (hasResult(td) && threadBestMove(td) == move)
+                    total += i64(td->score - minScore + SMP_VOTE_SCORE_OFFSET) * td->completedDepth;
+
+            return total;
+        };
+
+        for (const ThreadData* td : mThreadsData)
+        {
+            if (td == bestTd || !hasResult(td)) continue;
+
+            // If best thread has a mate score, only a better score can replace it
+            if (abs(bestTd->score) >= MIN_MATE_SCORE)
+            {
+                if (td->score > bestTd->score)
+                    bestTd = td;
+            }
+            else if (td->score >= MIN_MATE_SCORE
+            || (td->score > -MIN_MATE_SCORE && votes(threadBestMove(td)) > votes(threadBestMove(bestTd))))
+                bestTd = td;
+        }
+
+        return bestTd;
+    }
+
+    inline void startTimer()
+    {
+        if (mHardMs >= std::numeric_limits<i64>::max()) return;
+
+        const auto deadline = mStartTime + std::chrono::milliseconds(mHardMs);
+        mTimerCancelled = false;
+
+        mTimerThread = std::thread([this, deadline]() {
+            std::unique_lock<std::mutex> lock(mTimerMutex);
+
+            if (!mTimerCv.wait_until(lock, deadline, [this] { return mTimerCancelled; }))
+                mHardTimeUp = true;
+        });
+    }
+
+    inline void stopTimer()
+    {
+        if (!mTimerThread.joinable()) return;
+
+        {
+            std::lock_guard<std::mutex> lock(mTimerMutex);
+            mTimerCancelled = true;
+        }
+
+        mTimerCv.notify_one();
+        mTimerThread.join();
+    }
+
+    // Prints uci info (if mPrintInfo) and calls the iteration callback (if set)
+    // with td's last completed iteration
+    constexpr void reportIteration(const ThreadData &td, const u64 msElapsed)
+    {
+        if (mPrintInfo)
+        {
+            std::cout << "info"
+                      << " depth "    << td.completedDepth
+                      << " seldepth " << td.maxPlyReached;
+
+            if (abs(td.score) < MIN_MATE_SCORE)
+                std::cout << " score cp " << td.score;
+            else {
+                const i32 movesTillMate = round((INF - abs(td.score)) / 2.0);
+                std::cout << " score mate " << (td.score > 0 ? movesTillMate : -movesTillMate);
+            }
+
+            const u64 nodes = totalNodes();
+
+            std::cout << " nodes " << nodes
+                      << " nps "   << nodes * 1000 / std::max(msElapsed, (u64)1)
+                      << " time "  << msElapsed
+                      << " pv";
+
+            for (const Move move : td.pliesData[0].pvLine)
+                std::cout << " " << move.toUci();
+
+            std::cout << std::endl;
+        }
+
+        if (mOnIteration && !mIndependentSearches)
+        {
+            mOnIteration(SearchInfo {
+                .depth = td.completedDepth,
+                .seldepth = td.maxPlyReached,
+                .score = td.score,
+                .nodes = totalNodes(),
+                .milliseconds = msElapsed,
+                .pvLine = td.pliesData[0].pvLine
+            });
+        }
+    }
+
     constexpr void iterativeDeepening(ThreadData &td)
     {
         td.score = VALUE_NONE;
+        td.completedDepth = 0;
+        TimeManager timeManager = TimeManager();
+
         for (i32 iterationDepth = 1; iterationDepth <= mMaxDepth; iterationDepth++)
         {
+            // Lazy SMP: helper threads skip some depths
+            if (td.threadIdx > 0 && !mIndependentSearches && iterationDepth > 1)
+            {
+                const size_t i = (td.threadIdx - 1) % SMP_SKIP_SIZE.size();
+
+                if (((iterationDepth + SMP_SKIP_PHASE[i]) / SMP_SKIP_SIZE[i]) % 2 != 0)
+                    continue;
+            }
+
             td.maxPlyReached = 0;
 
             const i32 iterationScore = iterationDepth >= aspMinDepth()
                                        ? aspiration(td, iterationDepth)
-                                       : search(td, iterationDepth, 0, -INF, INF, false, DOUBLE_EXTENSIONS_MAX);
+                                       : search<NodeType::ROOT>(td, iterationDepth, 0, -INF, INF, false, DOUBLE_EXTENSIONS_MAX);
 
-            if (mStopSearch.load(std::memory_order_relaxed))
+            if (searchStopped(td))
                 break;
 
             td.score = iterationScore;
+            td.completedDepth = iterationDepth;
 
             // If not main thread, continue
-            if (&td != mainThreadData()) continue;
-
-            const u64 msElapsed = millisecondsElapsed(mStartTime);
+            if (!controlsSearch(td)) continue;
 
-            mStopSearch = msElapsed >= mHardMs
-                          || (mMaxNodes < std::numeric_limits<i64>::max() && totalNodes() >= mMaxNodes);
-
-            // Print uci info
-            if (mPrintInfo)
-            {
-                std::cout << "info"
-                          << " depth "    << iterationDepth
-                          << " seldepth " << td.maxPlyReached;
-
-                if (abs(td.score) < MIN_MATE_SCORE)
-                    std::cout << " score cp " << td.score;
-                else {
-                    const i32 movesTillMate = round((INF - abs(td.score)) / 2.0);
-                    std::cout << " score mate " << (td.score > 0 ? movesTillMate : -movesTillMate);
-                }
+            #if defined(SEARCH_STATS)
+                td.stats.nodesByDepth[iterationDepth] = searchNodes(td);
+            #endif
 
-                const u64 nodes = totalNodes();
+            const u64 msElapsed = millisecondsElapsed(mStartTime);
 
-                std::cout << " nodes " << nodes
-                          << " nps "   << nodes * 1000 / std::max(msElapsed, (u64)1)
-                          << " time "  << msElapsed
-                          << " pv";
+            if (msElapsed >= mHardMs
+            || (mMaxNodes < std::numeric_limits<i64>::max() && searchNodes(td) >= mMaxNodes))
+                stopSearch(td);
 
-                for (const Move move : td.pliesData[0].pvLine)
-                    std::cout << " " << move.toUci();
+            reportIteration(td, msElapsed);
 
-                std::cout << std::endl;
-            }
+            // Check soft nodes limit (in case one exists)
+            if (mSoftNodes < std::numeric_limits<i64>::max() && searchNodes(td) >= mSoftNodes)
+                break;
 
             // Check soft time limit (in case one exists)
 
             if (mSoftMs >= std::numeric_limits<i64>::max()) continue;
 
-            // Nodes time management: scale soft time limit based on nodes spent on best move
-            const auto scaledSoftMs = [&]() constexpr -> u64
-            {
-                const double bestMoveNodes = td.nodesByMove[bestMoveRoot().encoded()];
-                const double bestMoveNodesFraction = bestMoveNodes / std::max<double>(td.nodes, 1.0);
-                assert(bestMoveNodesFraction >= 0.0 && bestMoveNodesFraction <= 1.0);
-                return (double)mSoftMs * (1.5 - bestMoveNodesFraction);
-            };
+            // Scale soft time limit based on nodes spent on best move,
+            // best move stability and score drop
+            const double bestMoveNodes = td.nodesByMove[bestMoveRoot().encoded()];
+            const double bestMoveNodesFraction = bestMoveNodes / std::max<double>(td.nodes, 1.0);
+            const double softMsScale = timeManager.update(bestMoveRoot(), td.score, bestMoveNodesFraction);
+
+            const u64 scaledSoftMs = iterationDepth >= aspMinDepth() ? (double)mSoftMs * softMsScale : mSoftMs;
 
-            if (msElapsed >= (iterationDepth >= aspMinDepth() ? scaledSoftMs() : mSoftMs))
+            if (msElapsed >= scaledSoftMs)
                 break;
         }
 
         // If main thread, signal other threads to stop searching
-        if (&td == mainThreadData()) mStopSearch = true;
+        if (!mIndependentSearches && &td == mainThreadData()) {
+            mStopTime = std::chrono::steady_clock::now();
+            mStopSearch = true;
+        }
     }
 
-    constexpr bool shouldStop(const ThreadData &td)
+    constexpr bool shouldStop(ThreadData &td)
     {
-        if (mStopSearch.load(std::memory_order_relaxed))
+        if (searchStopped(td))
             return true;
 
-        // Only check stop conditions and modify mStopSearch in main thread
+        // Only check stop conditions and stop the search in main thread
         // Don't stop searching if depth 1 not completed
-        if (&td != mainThreadData() || mainThreadData()->score == VALUE_NONE)
+        if (!controlsSearch(td) || td.score == VALUE_NONE)
             return false;
 
-        if (mMaxNodes < std::numeric_limits<i64>::max() && totalNodes() >= mMaxNodes)
-            return mStopSearch = true;
+        if (mMaxNodes < std::numeric_limits<i64>::max() && searchNodes(td) >= mMaxNodes)
+            return stopSearch(td);
 
-        // Check time every N nodes
-        if (td.nodes % 1024 != 0) return false;
-
-        return mStopSearch = (millisecondsElapsed(mStartTime) >= mHardMs);
+        // Set by the timer thread when hard time limit is reached
+        return mHardTimeUp.load(std::memory_order_relaxed) && stopSearch(td);
     }
 
     constexpr i32 aspiration(ThreadData &td, const i32 iterationDepth)
@@ -334,10 +724,14 @@ class Searcher {
         i32 beta  = std::min(INF,  td.score + delta);
 
         while (true) {
-            i32 score = search(td, depth, 0, alpha, beta, false, DOUBLE_EXTENSIONS_MAX);
+            i32 score = search<NodeType::ROOT>(td, depth, 0, alpha, beta, false, DOUBLE_EXTENSIONS_MAX);
 
             if (shouldStop(td)) return 0;
 
+            // The window can't widen further, e.g. root has no legal moves
+            if ((score >= beta && beta >= INF) || (score <= alpha && alpha <= -INF))
+                return score;
+
             if (score >= beta) {
                 beta = std::min(beta + delta, INF);
                 if (depth > 1) depth--;
@@ -355,9 +749,17 @@ class Searcher {
         }
     }
 
+    template <NodeType nodeType>
     constexpr i32 search(ThreadData &td, i32 depth, const i32 ply, i32 alpha, i32 beta,
         const bool cutNode, i32 doubleExtsLeft, const Move singularMove = MOVE_NONE)
     {
+        constexpr bool rootNode = nodeType == NodeType::ROOT;
+        constexpr bool pvNode   = nodeType == NodeType::ROOT || nodeType == NodeType::PV;
+        constexpr bool singular = nodeType == NodeType::SINGULAR;
+
+        assert(rootNode == (ply == 0));
+        assert(pvNode || alpha + 1 == beta);
+        assert(singular == (singularMove != MOVE_NONE));
         assert(ply >= 0 && ply <= mMaxDepth);
         assert(alpha >= -INF && alpha <= INF);
         assert(beta  >= -INF && beta  <= INF);
@@ -366,10 +768,15 @@ class Searcher {
         if (shouldStop(td)) return 0;
 
         // Cuckoo / detect upcoming repetition
-        if (ply > 0 && alpha < 0 && td.board.hasUpcomingRepetition(ply))
+        if (!rootNode && alpha < 0 && td.board.hasUpcomingRepetition(ply))
         {
             alpha = 0;
             if (alpha >= beta) return alpha;
+
+            // Window became null, so this is no longer a PV node
+            if constexpr (nodeType == NodeType::PV)
+                if (alpha + 1 == beta)
+                    return search<NodeType::NON_PV>(td, depth, ply, alpha, beta, cutNode, doubleExtsLeft);
         }
 
         // Quiescence search at leaf nodes
@@ -377,14 +784,21 @@ class Searcher {
 
         if (depth > mMaxDepth) depth = mMaxDepth;
 
-        const bool pvNode = beta > alpha + 1 || ply == 0;
-
         // Probe TT
         const auto ttEntryIdx = TTEntryIndex(td.board.zobristHash(), mTT.size());
-        TTEntry ttEntry = singularMove != MOVE_NONE ? TTEntry() : mTT[ttEntryIdx];
+        TTEntry ttEntry;
+
+        {
+            PROFILE_SCOPE(ProfilePhase::TT_PROBE);
+            ttEntry = singular ? TTEntry() : mTT[ttEntryIdx];
+        }
+
         const bool ttHit = td.board.zobristHash() == ttEntry.zobristHash;
         Move ttMove = MOVE_NONE;
 
+        STATS_ADD(td, ttProbes, !singular);
+        STATS_ADD(td, ttHits, ttHit);
+
         if (ttHit) {
             ttEntry.adjustScore(ply);
             ttMove = Move(ttEntry.move);
@@ -395,7 +809,10 @@ class Searcher {
             && (ttEntry.bound() == Bound::EXACT
             || (ttEntry.bound() == Bound::LOWER && ttEntry.score >= beta)
             || (ttEntry.bound() == Bound::UPPER && ttEntry.score <= alpha)))
+            {
+                STATS_INC(td, ttCutoffs);
                 return ttEntry.score;
+            }
         }
 
         PlyData* plyDataPtr = &(td.pliesData[ply]);
@@ -417,23 +834,33 @@ class Searcher {
         (plyDataPtr + 1)->killer = MOVE_NONE;
 
         // Node pruning
-        if (!pvNode && !td.board.inCheck() && singularMove == MOVE_NONE)
+        if (!pvNode && !singular && !td.board.inCheck())
         {
             // RFP (Reverse futility pruning) / Static NMP
+            STATS_ADD(td, rfpTries, depth <= rfpMaxDepth());
+
             if (depth <= rfpMaxDepth()
             && eval >= beta + (depth - improving) * rfpDepthMul())
+            {
+                STATS_INC(td, rfpCutoffs);
                 return eval;
+            }
 
             // Razoring
             if (depth <= razoringMaxDepth()
             && abs(alpha) < 2000
             && eval + depth * razoringDepthMul() < alpha)
             {
+                STATS_INC(td, razoringTries);
+
                 const i32 score = qSearch(td, ply, alpha, beta);
 
                 if (shouldStop(td)) return 0;
 
-                if (score <= alpha) return score;
+                if (score <= alpha) {
+                    STATS_INC(td, razoringCutoffs);
+                    return score;
+                }
             }
 
             // NMP (Null move pruning)
@@ -444,19 +871,24 @@ class Searcher {
             && !(ttHit && ttEntry.bound() == Bound::UPPER && ttEntry.score < beta)
             && td.board.hasNonPawnMaterial(td.board.sideToMove()))
             {
+                STATS_INC(td, nmpTries);
+
                 td.makeMove(MOVE_NONE, ply + 1, mTT);
 
                 const i32 nmpDepth = depth - nmpBaseReduction() - depth * nmpDepthMul()
                                      - (ttMove != MOVE_NONE && !td.board.isQuiet(ttMove));
 
                 const i32 score = td.board.isDraw(ply + 1) ? 0
-                                  : -search(td, nmpDepth, ply + 1, -beta, -alpha, !cutNode, doubleExtsLeft);
+                                  : -search<NodeType::NON_PV>(td, nmpDepth, ply + 1, -beta, -alpha, !cutNode, doubleExtsLeft);
 
                 td.board.undoMove();
 
                 if (shouldStop(td)) return 0;
 
-                if (score >= beta) return score >= MIN_MATE_SCORE ? beta : score;
+                if (score >= beta) {
+                    STATS_INC(td, nmpCutoffs);
+                    return score >= MIN_MATE_SCORE ? beta : score;
+                }
             }
 
             // Probcut
@@ -466,19 +898,24 @@ class Searcher {
             && probcutBeta < MIN_MATE_SCORE - 1
             && !(ttHit && ttEntry.depth() >= depth - 3 && ttEntry.score < probcutBeta))
             {
+                STATS_INC(td, probcutTries);
+
                 const i32 probcutScore = probcut(
                     td, depth, ply, probcutBeta, cutNode, doubleExtsLeft, ttMove, ttEntryIdx);
 
                 if (shouldStop(td)) return 0;
 
-                if (probcutScore != VALUE_NONE) return probcutScore;
+                if (probcutScore != VALUE_NONE) {
+                    STATS_INC(td, probcutCutoffs);
+                    return probcutScore;
+                }
             }
         }
 
         // IIR (Internal iterative reduction)
         if (depth >= iirMinDepth()
         && (ttMove == MOVE_NONE || ttEntry.depth() < depth - iirMinDepth())
-        && singularMove == MOVE_NONE
+        && !singular
         && (pvNode || cutNode))
             depth--;
 
@@ -492,12 +929,12 @@ class Searcher {
         bool isBestMoveQuiet = false;
         Bound bound = Bound::UPPER;
 
-        ArrayVec<Move, 256> failLowQuiets;
-        ArrayVec<i16*, 256> failLowNoisiesHistory;
+        ArenaVec<Move> failLowQuiets(td.failLowQuietsArena);
+        ArenaVec<i16*> failLowNoisiesHistory(td.failLowNoisiesArena);
 
         // Moves loop
 
-        MovePicker movePicker = MovePicker(false);
+        MovePicker movePicker(false, td.scoredMovesArena);
         Move move;
 
         while ((move = movePicker.next(
@@ -528,7 +965,7 @@ class Searcher {
             if (!isQuiet) noisyHistoryPtr = historyEntry.noisyHistoryPtr(td.board.captured(move), move.promotion());
 
             // Moves loop pruning
-            if (ply > 0
+            if (!rootNode
             && bestScore > -MIN_MATE_SCORE
             && legalMovesSeen >= 3
             && (movePicker.stage() == MoveGenStage::QUIETS || movePicker.stage() == MoveGenStage::BAD_NOISIES))
@@ -562,7 +999,7 @@ class Searcher {
             // In singular searches, ttMove = MOVE_NONE, which prevents SE
             i32 singularBeta;
             if (move == ttMove
-            && ply > 0
+            && !rootNode
             && depth >= singularMinDepth()
             && ttEntry.depth() >= depth - singularDepthMargin()
             && ttEntry.bound() != Bound::UPPER
@@ -572,23 +1009,32 @@ class Searcher {
                 // Singular search: before searching any move,
                 // search this node at a shallower depth with TT move excluded
 
-                const i32 singularScore = search(
+                const i32 singularScore = search<NodeType::SINGULAR>(
                     td, (depth - 1) / 2, ply, singularBeta - 1, singularBeta, cutNode, doubleExtsLeft, ttMove);
 
+                STATS_INC(td, singularSearches);
+
                 // Double extension
                 if (!pvNode && singularScore < singularBeta - doubleExtensionMargin() && doubleExtsLeft > 0) {
+                    STATS_INC(td, doubleExtensions);
                     newDepth += 2;
                     doubleExtsLeft--;
                 }
                 // Normal singular extension
-                else if (singularScore < singularBeta)
+                else if (singularScore < singularBeta) {
+                    STATS_INC(td, singularExtensions);
                     newDepth++;
+                }
                 // Multicut
-                else if (singularBeta >= beta)
+                else if (singularBeta >= beta) {
+                    STATS_INC(td, multicuts);
                     return singularBeta;
+                }
                 // Negative extension
-                else if (cutNode)
+                else if (cutNode) {
+                    STATS_INC(td, negativeExtensions);
                     newDepth -= 2;
+                }
             }
 
             const u64 nodesBefore = td.nodes;
@@ -620,22 +1066,29 @@ class Searcher {
 
                 if (lmr < 0) lmr = 0; // dont extend
 
-                score = -search(td, newDepth - lmr, ply + 1, -alpha - 1, -alpha, true, doubleExtsLeft);
+                score = -search<NodeType::NON_PV>(td, newDepth - lmr, ply + 1, -alpha - 1, -alpha, true, doubleExtsLeft);
+
+                STATS_INC(td, lmrSearches);
 
                 if (score > alpha && lmr > 0)
                 {
+                    STATS_INC(td, lmrResearches);
+
                     // Deeper or shallower search?
-                    newDepth += ply > 0 && score > bestScore + deeperBase() + newDepth * 2;
-                    newDepth -= ply > 0 && score < bestScore + newDepth;
+                    newDepth += !rootNode && score > bestScore + deeperBase() + newDepth * 2;
+                    newDepth -= !rootNode && score < bestScore + newDepth;
 
-                    score = -search(td, newDepth, ply + 1, -alpha - 1, -alpha, !cutNode, doubleExtsLeft);
+                    score = -search<NodeType::NON_PV>(td, newDepth, ply + 1, -alpha - 1, -alpha, !cutNode, doubleExtsLeft);
                 }
             }
             else if (!pvNode || legalMovesSeen > 1)
-                score = -search(td, newDepth, ply + 1, -alpha - 1, -alpha, !cutNode, doubleExtsLeft);
+                score = -search<NodeType::NON_PV>(td, newDepth, ply + 1, -alpha - 1, -alpha, !cutNode, doubleExtsLeft);
 
+            // If alpha was raised to beta - 1, the child's window is null, so it isn't a PV node
             if (pvNode && (legalMovesSeen == 1 || score > alpha))
-                score = -search(td, newDepth, ply + 1, -beta, -alpha, false, doubleExtsLeft);
+                score = beta > alpha + 1
+                        ? -search<NodeType::PV>(td, newDepth, ply + 1, -beta, -alpha, false, doubleExtsLeft)
+                        : -search<NodeType::NON_PV>(td, newDepth, ply + 1, -beta, -alpha, false, doubleExtsLeft);
 
             moveSearched:
 
@@ -645,7 +1098,7 @@ class Searcher {
             if (shouldStop(td)) return 0;
 
             assert(td.nodes > nodesBefore);
-            if (ply == 0) td.nodesByMove[move.encoded()] += td.nodes - nodesBefore;
+            if constexpr (rootNode) td.nodesByMove[move.encoded()] += td.nodes - nodesBefore;
 
             if (score > bestScore) bestScore = score;
 
@@ -665,7 +1118,7 @@ class Searcher {
             bound = Bound::EXACT;
 
             // If PV node, update PV line
-            if (pvNode) {
+            if constexpr (pvNode) {
                 plyDataPtr->pvLine.clear();
                 plyDataPtr->pvLine.push_back(move);
 
@@ -680,6 +1133,9 @@ class Searcher {
 
             bound = Bound::LOWER;
 
+            STATS_INC(td, failHighs);
+            STATS_ADD(td, failHighsFirstMove, legalMovesSeen == 1);
+
             const i32 bonus =  std::clamp(depth * historyBonusMul() - historyBonusOffset(), 0, historyBonusMax());
             const i32 malus = -std::clamp(depth * historyMalusMul() - historyMalusOffset(), 0, historyMalusMax());
 
@@ -696,7 +1152,7 @@ class Searcher {
             // This move is a fail high quiet
 
             plyDataPtr->killer = move;
-            const Color nstm = td.board.oppSide();
+            const u64 enemyAttacks = td.board.attacks(td.board.oppSide());
 
             const std::array<Move, 3> lastMoves = {
                 td.board.lastMove(), td.board.nthToLastMove(2), td.board.nthToLastMove(4)
@@ -704,8 +1160,8 @@ class Searcher {
 
             // History bonus: increase this move's history
             historyEntry.updateQuietHistories(
-                td.board.isSquareAttacked(move.from(), nstm),
-                td.board.isSquareAttacked(move.to(),   nstm),
+                enemyAttacks & bitboard(move.from()),
+                enemyAttacks & bitboard(move.to()),
                 lastMoves,
                 bonus
             );
@@ -715,8 +1171,8 @@ class Searcher {
                 pt = int(failLow.pieceType());
 
                 td.historyTable[stm][pt][failLow.to()].updateQuietHistories(
-                    td.board.isSquareAttacked(failLow.from(), nstm),
-                    td.board.isSquareAttacked(failLow.to(),   nstm),
+                    enemyAttacks & bitboard(failLow.from()),
+                    enemyAttacks & bitboard(failLow.to()),
                     lastMoves,
                     malus
                 );
@@ -726,7 +1182,7 @@ class Searcher {
         }
 
         if (legalMovesSeen == 0) {
-            if (singularMove != MOVE_NONE) return alpha;
+            if constexpr (singular) return alpha;
 
             assert(!td.board.hasLegalMove());
 
@@ -736,7 +1192,7 @@ class Searcher {
 
         assert(td.board.hasLegalMove());
 
-        if (singularMove == MOVE_NONE) {
+        if constexpr (!singular) {
             // Store in TT
             mTT[ttEntryIdx].update(td.board.zobristHash(), depth, ply, bestScore, bestMove, bound);
 
@@ -766,9 +1222,18 @@ class Searcher {
 
         // Probe TT
         const auto ttEntryIdx = TTEntryIndex(td.board.zobristHash(), mTT.size());
-        TTEntry ttEntry = mTT[ttEntryIdx];
+        TTEntry ttEntry;
+
+        {
+            PROFILE_SCOPE(ProfilePhase::TT_PROBE);
+            ttEntry = mTT[ttEntryIdx];
+        }
+
         const bool ttHit = td.board.zobristHash() == ttEntry.zobristHash;
 
+        STATS_INC(td, ttProbes);
+        STATS_ADD(td, ttHits, ttHit);
+
         // TT cutoff
         if (ttHit) {
             ttEntry.adjustScore(ply);
@@ -776,7 +1241,10 @@ class Searcher {
             if (ttEntry.bound() == Bound::EXACT
             || (ttEntry.bound() == Bound::LOWER && ttEntry.score >= beta)
             || (ttEntry.bound() == Bound::UPPER && ttEntry.score <= alpha))
+            {
+                STATS_INC(td, ttCutoffs);
                 return ttEntry.score;
+            }
         }
 
         PlyData* plyDataPtr = &(td.pliesData[ply]);
@@ -798,7 +1266,7 @@ class Searcher {
 
         // Moves loop
 
-        MovePicker movePicker = MovePicker(!td.board.inCheck());
+        MovePicker movePicker(!td.board.inCheck(), td.scoredMovesArena);
         Move move;
         const Move ttMove = !ttHit || !td.board.inCheck() ? MOVE_NONE : Move(ttEntry.move);
 
@@ -870,7 +1338,7 @@ class Searcher {
 
         // Moves loop
 
-        MovePicker movePicker = MovePicker(true);
+        MovePicker movePicker(true, td.scoredMovesArena);
         Move move;
 
         while ((move = movePicker.next(td.board, ttMove, plyDataPtr->killer, td.historyTable)) != MOVE_NONE)
@@ -896,7 +1364,7 @@ class Searcher {
             score = -qSearch(td, ply + 1, -probcutBeta, -probcutBeta + 1);
 
             if (score >= probcutBeta)
-                score = -search(td, depth - 4, ply + 1, -probcutBeta, -probcutBeta + 1, !cutNode, doubleExtsLeft);
+                score = -search<NodeType::NON_PV>(td, depth - 4, ply + 1, -probcutBeta, -probcutBeta + 1, !cutNode, doubleExtsLeft);
 
             moveSearched:
 
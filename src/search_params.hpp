@@ -49,6 +49,13 @@ constexpr i32 MAX_DEPTH = 100;
 // Time management
 MAYBE_CONSTEXPR TunableParam<double> hardTimePercentage = TunableParam<double>(0.73, 0.5, 0.75, 0.25 / 4.0);
 MAYBE_CONSTEXPR TunableParam<double> softTimePercentage = TunableParam<double>(0.105, 0.05, 0.25, 0.02);
+MAYBE_CONSTEXPR TunableParam<double> incrementPercentage = TunableParam<double>(0.75, 0.5, 1.0, 0.1);
+MAYBE_CONSTEXPR TunableParam<double> movesToGoHardMul    = TunableParam<double>(3.0, 2.0, 5.0, 0.5);
+MAYBE_CONSTEXPR TunableParam<double> movesToGoSoftMul    = TunableParam<double>(0.7, 0.4, 1.0, 0.1);
+MAYBE_CONSTEXPR TunableParam<double> tmStabilityBase     = TunableParam<double>(1.2, 1.0, 1.5, 0.05);
+MAYBE_CONSTEXPR TunableParam<double> tmStabilityMul      = TunableParam<double>(0.05, 0.02, 0.08, 0.01);
+MAYBE_CONSTEXPR TunableParam<i32>    tmScoreDropMax      = TunableParam<i32>(100, 50, 200, 25);
+MAYBE_CONSTEXPR TunableParam<double> tmScoreDropMul      = TunableParam<double>(0.004, 0.002, 0.008, 0.001);
 
 // Eval scale with material / game phase
 MAYBE_CONSTEXPR TunableParam<float> evalMaterialScaleMin = TunableParam<float>(0.75, 0.75, 1.0, 0.25 / 4.0);
@@ -65,6 +72,13 @@ MAYBE_CONSTEXPR std::array<i32, 7> SEE_PIECE_VALUES = {
     seePawnValue(), seeMinorValue(), seeMinorValue(), seeRookValue(),  seeQueenValue(), 0, 0
 };
 
+// Lazy SMP
+// Helper thread i skips iteration depth d if ((d + SMP_SKIP_PHASE[j]) / SMP_SKIP_SIZE[j]) is odd,
+// where j = (i - 1) % 20, so that helpers are spread over different depths
+constexpr std::array<i32, 20> SMP_SKIP_SIZE  = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+constexpr std::array<i32, 20> SMP_SKIP_PHASE = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+constexpr i32 SMP_VOTE_SCORE_OFFSET = 14;
+
 // Aspiration windows
 MAYBE_CONSTEXPR TunableParam<i32>    aspMinDepth     = TunableParam<i32>(7, 6, 10, 1);
 MAYBE_CONSTEXPR TunableParam<i32>    aspInitialDelta = TunableParam<i32>(13, 5, 25, 5);
@@ -192,6 +206,13 @@ MAYBE_CONST MultiArray<i32, 2, MAX_DEPTH+1, 256> LMR_TABLE = getLmrTable();
     tsl::ordered_map<std::string, TunableParamVariant> tunableParams = {
         {stringify(hardTimePercentage), &hardTimePercentage},
         {stringify(softTimePercentage), &softTimePercentage},
+        {stringify(incrementPercentage), &incrementPercentage},
+        {stringify(movesToGoHardMul), &movesToGoHardMul},
+        {stringify(movesToGoSoftMul), &movesToGoSoftMul},
+        {stringify(tmStabilityBase), &tmStabilityBase},
+        {stringify(tmStabilityMul), &tmStabilityMul},
+        {stringify(tmScoreDropMax), &tmScoreDropMax},
+        {stringify(tmScoreDropMul), &tmScoreDropMul},
         {stringify(evalMaterialScaleMin), &evalMaterialScaleMin},
         {stringify(evalMaterialScaleMax), &evalMaterialScaleMax},
         {stringify(seePawnValue), &seePawnValue},
@@ -0,0 +1,108 @@
+// clang-format off
+
+#pragma once
+
+#include "utils.hpp"
+#include "search_params.hpp"
+
+// Search statistics counters
+// Compile with -DSEARCH_STATS ("make stats") to collect them
+// Without SEARCH_STATS, STATS_INC() and STATS_ADD() expand to nothing and all counters stay at 0
+
+#if defined(SEARCH_STATS)
+    #define STATS_INC(td, counter) ((td).stats.counter++)
+    #define STATS_ADD(td, counter, value) ((td).stats.counter += (value))
+#else
+    #define STATS_INC(td, counter)
+    #define STATS_ADD(td, counter, value)
+#endif
+
+struct SearchStats {
+    public:
+
+    u64 ttProbes = 0, ttHits = 0, ttCutoffs = 0;
+
+    // Tries = node pruning conditions met except the eval/score condition (rfp, probcut)
+    // or including the eval condition, so every try is a verification search (razoring, nmp)
+    // So rfp and probcut cutoff rates aren't comparable with razoring and nmp ones
+    u64 rfpTries = 0,      rfpCutoffs = 0;
+    u64 razoringTries = 0, razoringCutoffs = 0;
+    u64 nmpTries = 0,      nmpCutoffs = 0;
+    u64 probcutTries = 0,  probcutCutoffs = 0;
+
+    u64 lmrSearches = 0, lmrResearches = 0;
+
+    u64 singularSearches = 0, singularExtensions = 0, doubleExtensions = 0;
+    u64 multicuts = 0, negativeExtensions = 0;
+
+    u64 failHighs = 0, failHighsFirstMove = 0;
+
+    // Total nodes (all threads) when main thread completed each iteration
+    // Only filled in main thread's stats
+    std::array<u64, MAX_DEPTH + 1> nodesByDepth = { }; // [depth]
+
+    constexpr SearchStats& operator+=(const SearchStats &other)
+    {
+        for (const auto member : COUNTERS) this->*member += other.*member;
+        return *this;
+    }
+
+    private:
+
+    static constexpr std::array<u64 SearchStats::*, 20> COUNTERS = {
+        &SearchStats::ttProbes,         &SearchStats::ttHits,             &SearchStats::ttCutoffs,
+        &SearchStats::rfpTries,         &SearchStats::rfpCutoffs,
+        &SearchStats::razoringTries,    &SearchStats::razoringCutoffs,
+        &SearchStats::nmpTries,         &SearchStats::nmpCutoffs,
+        &SearchStats::probcutTries,     &SearchStats::probcutCutoffs,
+        &SearchStats::lmrSearches,      &SearchStats::lmrResearches,
+        &SearchStats::singularSearches, &SearchStats::singularExtensions, &SearchStats::doubleExtensions,
+        &SearchStats::multicuts,        &SearchStats::negativeExtensions,
+        &SearchStats::failHighs,        &SearchStats::failHighsFirstMove
+    };
+
+    public:
+
+    inline void print(const u64 nodes, const i32 completedDepth) const
+    {
+        const auto percentage = [](const u64 a, const u64 b) -> double {
+            return b > 0 ? round((double)a * 1000.0 / (double)b) / 10.0 : 0.0;
+        };
+
+        const auto printLine = [&](const std::string &name, const u64 count, const u64 total) {
+            std::cout << "info string stats " << name
+                      << " " << count << "/" << total
+                      << " (" << percentage(count, total) << "%)"
+                      << std::endl;
+        };
+
+        std::cout << "info string stats nodes " << nodes << " depth " << completedDepth << std::endl;
+
+        printLine("tt hits",             ttHits,             ttProbes);
+        printLine("tt cutoffs",          ttCutoffs,          ttProbes);
+        printLine("rfp cutoffs",         rfpCutoffs,         rfpTries);
+        printLine("razoring cutoffs",    razoringCutoffs,    razoringTries);
+        printLine("nmp cutoffs",         nmpCutoffs,         nmpTries);
+        printLine("probcut cutoffs",     probcutCutoffs,     probcutTries);
+        printLine("lmr researches",      lmrResearches,      lmrSearches);
+        printLine("singular extensions", singularExtensions, singularSearches);
+        printLine("double extensions",   doubleExtensions,   singularSearches);
+        printLine("multicuts",           multicuts,          singularSearches);
+        printLine("negative extensions", negativeExtensions, singularSearches);
+        printLine("first move cutoffs",  failHighsFirstMove, failHighs);
+
+        // Effective branching factor: growth of total nodes per iteration
+        if (completedDepth >= 2 && nodesByDepth[completedDepth - 1] > 0)
+        {
+            const i32 depthsBack = std::min(completedDepth - 1, 4);
+            const u64 nodesBefore = std::max<u64>(nodesByDepth[completedDepth - depthsBack], 1);
+
+            std::cout << "info string stats ebf "
+                      << (double)nodesByDepth[completedDepth] / (double)nodesByDepth[completedDepth - 1]
+                      << " avg ebf (last " << depthsBack << " iterations) "
+                      << pow((double)nodesByDepth[completedDepth] / (double)nodesBefore, 1.0 / depthsBack)
+                      << std::endl;
+        }
+    }
+
+}; // struct SearchStats
@@ -8,6 +8,7 @@
 #include "tt.hpp"
 #include "history_entry.hpp"
 #include "nnue.hpp"
+#include "search_stats.hpp"
 #include <mutex>
 #include <condition_variable>
 
@@ -18,8 +19,19 @@ struct PlyData {
     i32 eval = VALUE_NONE;
 };
 
+// Move lists of search nodes are allocated in per-thread arenas instead of the stack
+// Only nodes at ply < MAX_DEPTH create move lists (deeper ones return eval first),
+// each ply has at most 2 nodes with live move lists (a node and its singular search, probcut or razoring qsearch)
+// and a node's move list holds at most its pseudolegal moves (ArrayVec<Move, 256>)
+constexpr size_t MAX_MOVE_LISTS_PER_PLY = 2;
+constexpr size_t MAX_MOVES_PER_LIST = 256;
+constexpr size_t MOVES_ARENA_CAPACITY = MAX_MOVE_LISTS_PER_PLY * (MAX_DEPTH + 1) * MAX_MOVES_PER_LIST;
+
+static_assert(MOVES_ARENA_CAPACITY >= MAX_MOVE_LISTS_PER_PLY * MAX_DEPTH * MAX_MOVES_PER_LIST,
+    "Moves arenas must fit every live move list of a search down to MAX_DEPTH");
+
 enum class ThreadState {
-    SLEEPING, SEARCHING, EXIT_ASAP, EXITED
+    SLEEPING, SEARCHING, ANALYZING, EXIT_ASAP, EXITED
 };
 
 struct ThreadData {
@@ -27,11 +39,17 @@ struct ThreadData {
 
     Board board = START_BOARD;
 
+    size_t threadIdx = 0; // 0 = main thread
+
     i32 score = 0;
+    i32 completedDepth = 0;
 
     u64 nodes = 0;
     i32 maxPlyReached = 0;
 
+    // Stops this thread's search in Searcher::analyze(), where each thread searches its own position
+    bool stopSearch = false;
+
     std::array<PlyData, MAX_DEPTH+1> pliesData; // [ply]
 
     // [stm][pieceType][targetSquare]
@@ -39,6 +57,12 @@ struct ThreadData {
 
     std::array<u64, 1ULL << 17> nodesByMove; // [move]
 
+    SearchStats stats; // only collected if compiled with SEARCH_STATS
+
+    Arena<i64>  scoredMovesArena    = Arena<i64>(MOVES_ARENA_CAPACITY);  // move pickers' scored moves
+    Arena<Move> failLowQuietsArena  = Arena<Move>(MOVES_ARENA_CAPACITY);
+    Arena<i16*> failLowNoisiesArena = Arena<i16*>(MOVES_ARENA_CAPACITY); // noisy histories pointers
+
     std::array<BothAccumulators, MAX_DEPTH+1> accumulators;
     BothAccumulators* accumulatorPtr = &accumulators[0];
 
@@ -85,6 +109,8 @@ struct ThreadData {
 
     constexpr void makeMove(const Move move, const i32 newPly, const std::vector<TTEntry> &tt)
     {
+        PROFILE_SCOPE(ProfilePhase::MAKE_MOVE);
+
         // If not a special move, we can probably correctly predict the zobrist hash after it
         // and prefetch the TT entry
         if (move.flag() <= Move::KING_FLAG) {
@@ -113,6 +139,8 @@ struct ThreadData {
 
     constexpr i32 updateAccumulatorAndEval(i32 &eval)
     {
+        PROFILE_SCOPE(ProfilePhase::UPDATE_ACC_AND_EVAL);
+
         assert(accumulatorPtr == &accumulators[0]
                ? accumulatorPtr->mUpdated
                : (accumulatorPtr - 1)->mUpdated);
@@ -0,0 +1,91 @@
+// clang-format off
+
+#pragma once
+
+#include "utils.hpp"
+#include "move.hpp"
+#include "search_params.hpp"
+
+// Returns {hard limit, soft limit} in milliseconds for a 'go' command
+// A limit of i64 max means there is no such limit
+// moveOverheadMs is reserved for communication delays (GUI, network)
+constexpr std::pair<i64, i64> searchTimeLimits(
+    const i64 milliseconds,
+    const i64 incrementMs,
+    const i64 movesToGo,
+    const bool isMoveTime,
+    const i64 moveOverheadMs)
+{
+    constexpr i64 NO_LIMIT = std::numeric_limits<i64>::max();
+
+    if (milliseconds >= NO_LIMIT)
+        return { NO_LIMIT, NO_LIMIT };
+
+    const i64 timeLeft = std::max<i64>(0, milliseconds - moveOverheadMs);
+
+    if (isMoveTime)
+        return { timeLeft, NO_LIMIT };
+
+    double hardMs = (double)timeLeft * hardTimePercentage();
+    double softMs;
+
+    if (movesToGo > 0) {
+        // Spread remaining time over the moves left until the next time control
+        const double timePerMove = (double)timeLeft / (double)movesToGo;
+        hardMs = std::min(hardMs, timePerMove * movesToGoHardMul());
+        softMs = timePerMove * movesToGoSoftMul();
+    }
+    else
+        softMs = hardMs * softTimePercentage();
+
+    // The increment is given back after this move, so most of it can be spent now
+    softMs += (double)incrementMs * incrementPercentage();
+
+    return { (i64)hardMs, (i64)std::min(softMs, hardMs) };
+}
+
+// Main thread's iterative deepening state for scaling the soft time limit
+class TimeManager {
+    private:
+
+    Move mBestMove = MOVE_NONE;
+    i32 mBestMoveStability = 0;
+    i32 mLastScore = VALUE_NONE;
+
+    public:
+
+    constexpr static i32 BEST_MOVE_STABILITY_MAX = 8;
+
+    // Call once per completed iteration
+    // Returns the factor by which to scale the soft time limit
+    constexpr double update(const Move bestMove, const i32 score, const double bestMoveNodesFraction)
+    {
+        assert(bestMoveNodesFraction >= 0.0 && bestMoveNodesFraction <= 1.0);
+
+        mBestMoveStability = bestMove == mBestMove
+                             ? std::min(mBestMoveStability + 1, BEST_MOVE_STABILITY_MAX)
+                             : 0;
+
+        mBestMove = bestMove;
+
+        // Nodes: spend less time if most of the nodes were spent on the best move
+        const double nodesScale = 1.5 - bestMoveNodesFraction;
+
+        // Best move stability: spend less time if best move has been the same for many iterations
+        const double stabilityScale = tmStabilityBase() - tmStabilityMul() * (double)mBestMoveStability;
+
+        // Score drop: spend more time if score dropped since last iteration
+        double scoreDropScale = 1.0;
+
+        if (mLastScore != VALUE_NONE && abs(mLastScore) < MIN_MATE_SCORE && abs(score) < MIN_MATE_SCORE)
+        {
+            const i32 scoreDrop = std::clamp<i32>(mLastScore - score, 0, tmScoreDropMax());
+            scoreDropScale += (double)scoreDrop * tmScoreDropMul();
+        }
+
+        mLastScore = score;
+
+        return nodesScale * stabilityScale * scoreDropScale;
+    }
+
+}; // class TimeManager
@@ -6,10 +6,23 @@
 #include "board.hpp"
 #include "search.hpp"
 #include "bench.hpp"
+#include "datagen.hpp"
+#include "rescore.hpp"
+#include "eval_batch.hpp"
+#include "analyze.hpp"
 #include "nnue.hpp"
 
 namespace uci { // Universal chess interface
 
+// Options handled by the UCI layer instead of the searcher
+inline i64 moveOverheadMs = 10;
+inline bool reportLatency = false;
+
+// std::thread::hardware_concurrency() may return 0
+inline int defaultNumThreads() {
+    return std::max<int>(std::thread::hardware_concurrency(), 1);
+}
+
 inline void uci();
 inline void setoption(const std::vector<std::string> &tokens, Searcher &searcher);
 constexpr void position(const std::vector<std::string> &tokens, Board &board);
@@ -43,12 +56,128 @@ inline bool runCommand(std::string &command, Searcher &searcher)
         searcher.board().print();
     else if (tokens[0] == "bench")
     {
-        if (tokens.size() == 1)
-            bench();
-        else {
-            const int depth = stoi(tokens[1]);
-            bench(depth);
+        // bench <depth> <threads> <hashMB> <fenfile|default> [json <file>] [compare <baseline json file>] [perf]
+
+        std::vector<std::string> args = { };
+        std::string jsonFile = "", baselineFile = "";
+        bool perf = false;
+
+        for (size_t i = 1; i < tokens.size(); i++)
+        {
+            if (tokens[i] == "json" && i + 1 < tokens.size())
+                jsonFile = tokens[++i];
+            else if (tokens[i] == "compare" && i + 1 < tokens.size())
+                baselineFile = tokens[++i];
+            else if (tokens[i] == "perf")
+                perf = true;
+            else
+                args.push_back(tokens[i]);
+        }
+
+        bench(
+            args.size() > 0 ? stoi(args[0])  : 14,
+            args.size() > 1 ? stoi(args[1])  : 1,
+            args.size() > 2 ? stoll(args[2]) : 32,
+            args.size() > 3 ? args[3] : "default",
+            jsonFile,
+            baselineFile,
+            perf
+        );
+    }
+    else if (tokens[0] == "benchsmp") // benchsmp <depth> <maxThreads> <hashMB>
+    {
+        const int depth      = tokens.size() > 1 ? stoi(tokens[1]) : 12;
+        const int maxThreads = tokens.size() > 2 ? stoi(tokens[2]) : defaultNumThreads();
+        const i64 hashMB     = tokens.size() > 3 ? stoll(tokens[3]) : 32;
+
+        benchSMP(depth, maxThreads, hashMB);
+    }
+    else if (tokens[0] == "datagen")
+    {
+        // datagen <output file> <threads> <games> <soft nodes> [book <fens file>]
+
+        std::vector<std::string> args = { };
+        std::string bookFile = "";
+
+        for (size_t i = 1; i < tokens.size(); i++)
+        {
+            if (tokens[i] == "book" && i + 1 < tokens.size())
+                bookFile = tokens[++i];
+            else
+                args.push_back(tokens[i]);
+        }
+
+        datagen(
+            args.size() > 0 ? args[0] : "data.bin",
+            args.size() > 1 ? std::max(stoi(args[1]), 1) : defaultNumThreads(),
+            args.size() > 2 ? stoull(args[2]) : 1'000'000,
+            args.size() > 3 ? stoull(args[3]) : 5000,
+            bookFile
+        );
+    }
+    else if (tokens[0] == "rescore")
+    {
+        // rescore <input file> <output file> [threads <n>] [depth <d>] [nodes <n>] [hash <MB>]
+
+        if (tokens.size() < 3) {
+            std::cout << "info string Usage: rescore <input file> <output file> [threads <n>] [depth <d>] [nodes <n>] [hash <MB>]" << std::endl;
+            return true;
+        }
+
+        int numThreads = defaultNumThreads();
+        i32 depth = 0;
+        u64 nodes = std::numeric_limits<u64>::max();
+        i64 hashMB = 16;
+
+        for (size_t i = 3; i + 1 < tokens.size(); i += 2)
+        {
+            if (tokens[i] == "threads")
+                numThreads = std::max(stoi(tokens[i + 1]), 1);
+            else if (tokens[i] == "depth")
+                depth = stoi(tokens[i + 1]);
+            else if (tokens[i] == "nodes")
+                nodes = stoull(tokens[i + 1]);
+            else if (tokens[i] == "hash")
+                hashMB = stoll(tokens[i + 1]);
+        }
+
+        // Default depth 10, or no depth limit if nodes limited
+        if (depth <= 0)
+            depth = nodes < std::numeric_limits<i64>::max() ? MAX_DEPTH : 10;
+
+        rescore(tokens[1], tokens[2], numThreads, depth, nodes, hashMB);
+    }
+    else if (tokens[0] == "analyze")
+    {
+        // analyze [depth <d>] [nodes <n>] [file <fens or .bin file>]
+
+        i32 depth = 0;
+        u64 nodes = std::numeric_limits<u64>::max();
+        std::string inFile = "";
+
+        for (size_t i = 1; i + 1 < tokens.size(); i += 2)
+        {
+            if (tokens[i] == "depth")
+                depth = stoi(tokens[i + 1]);
+            else if (tokens[i] == "nodes")
+                nodes = stoull(tokens[i + 1]);
+            else if (tokens[i] == "file")
+                inFile = tokens[i + 1];
         }
+
+        // Default depth 10, or no depth limit if nodes limited
+        if (depth <= 0)
+            depth = nodes < std::numeric_limits<i64>::max() ? MAX_DEPTH : 10;
+
+        analyze(searcher, depth, nodes, inFile);
+    }
+    else if (command == "stats")
+    {
+        #if defined(SEARCH_STATS)
+            searcher.printStats();
+        #else
+            std::cout << "info string Search stats are only collected if compiled with SEARCH_STATS (make stats)" << std::endl;
+        #endif
     }
     else if (command == "eval")
     {
@@ -60,16 +189,37 @@ inline bool runCommand(std::string &command, Searcher &searcher)
                   << " scaled " << evalScaled
                   << std::endl;
     }
-    else if (tokens[0] == "perft")
+    else if (tokens[0] == "evalbatch") // evalbatch <input file> <output file> [threads]
+    {
+        if (tokens.size() < 3) {
+            std::cout << "info string Usage: evalbatch <input file> <output file> [threads]" << std::endl;
+            return true;
+        }
+
+        const int numThreads = tokens.size() > 3 ? std::max(stoi(tokens[3]), 1) : defaultNumThreads();
+
+        evalBatch(tokens[1], tokens[2], numThreads);
+    }
+    else if (tokens[0] == "perft") // perft <depth> [perf]
     {
         const int depth = stoi(tokens[1]);
         const std::string fen = searcher.board().fen();
 
         std::cout << "perft depth " << depth << " '" << fen << "'" << std::endl;
 
+        std::unique_ptr<PerfCounters> perfCounters
+            = tokens.size() > 2 && tokens[2] == "perf" ? std::make_unique<PerfCounters>() : nullptr;
+
+        if (perfCounters) perfCounters->start();
+
         const std::chrono::steady_clock::time_point start =  std::chrono::steady_clock::now();
         const u64 nodes = depth > 0 ? perft(searcher.board(), depth) : 0;
 
+        if (perfCounters) {
+            perfCounters->stop();
+            perfCounters->print(nodes);
+        }
+
         std::cout << "perft depth " << depth
                   << " nodes " << nodes
                   << " nps " << nodes * 1000 / std::max((u64)millisecondsElapsed(start), (u64)1)
@@ -150,6 +300,8 @@ inline void uci() {
     std::cout << "id author zzzzz" << std::endl;
     std::cout << "option name Hash type spin default 32 min 1 max 65536" << std::endl;
     std::cout << "option name Threads type spin default 1 min 1 max 256" << std::endl;
+    std::cout << "option name Move Overhead type spin default 10 min 0 max 5000" << std::endl;
+    std::cout << "option name Report Latency type check default false" << std::endl;
 
     #if defined(TUNE)
         for (auto &pair : tunableParams) {
@@ -176,8 +328,17 @@ inline void uci() {
 
 inline void setoption(const std::vector<std::string> &tokens, Searcher &searcher)
 {
-    const std::string optionName  = tokens[2];
-    const std::string optionValue = tokens[4];
+    // Option names may have spaces (e.g. "setoption name Move Overhead value 100")
+
+    std::string optionName = "";
+    size_t i = 2;
+
+    for (; i < tokens.size() && tokens[i] != "value"; i++)
+        optionName += tokens[i] + " ";
+
+    trim(optionName);
+
+    const std::string optionValue = i + 1 < tokens.size() ? tokens[i + 1] : "";
 
     if (optionName == "Hash" || optionName == "hash")
     {
@@ -189,6 +350,16 @@ inline void setoption(const std::vector<std::string> &tokens, Searcher &searcher
         const int newNumThreads = searcher.setThreads(stoi(optionValue));
         std::cout << "info string Threads set to " << newNumThreads << std::endl;
     }
+    else if (optionName == "Move Overhead" || optionName == "move overhead")
+    {
+        moveOverheadMs = std::clamp<i64>(stoll(optionValue), 0, 5000);
+        std::cout << "info string Move Overhead set to " << moveOverheadMs << std::endl;
+    }
+    else if (optionName == "Report Latency" || optionName == "report latency")
+    {
+        reportLatency = optionValue == "true";
+        std::cout << "info string Report Latency set to " << (reportLatency ? "true" : "false") << std::endl;
+    }
     #if defined(TUNE)
     else if (tunableParams.count(optionName) > 0)
     {
@@ -240,8 +411,8 @@ inline void go(const std::vector<std::string> &tokens, Searcher &searcher)
     const std::chrono::time_point<std::chrono::steady_clock> startTime = std::chrono::steady_clock::now();
 
     i64 milliseconds = std::numeric_limits<i64>::max();
-    [[maybe_unused]] i64 incrementMs = 0;
-    [[maybe_unused]] i64 movesToGo = 0;
+    i64 incrementMs = 0;
+    i64 movesToGo = 0;
     bool isMoveTime = false;
     i32 maxDepth = MAX_DEPTH;
     i64 maxNodes = std::numeric_limits<i64>::max();
@@ -271,19 +442,33 @@ inline void go(const std::vector<std::string> &tokens, Searcher &searcher)
             maxNodes = value;
     }
 
-    // Calculate search time limits
+    const auto [hardMs, softMs] = searchTimeLimits(
+        milliseconds, incrementMs, movesToGo, isMoveTime, moveOverheadMs
+    );
 
-    i64 hardMs = std::max<i64>(0, milliseconds - 10);
-    i64 softMs = std::numeric_limits<i64>::max();
-
-    if (!isMoveTime) {
-        hardMs *= hardTimePercentage();
-        softMs = hardMs * softTimePercentage();
-    }
+    #if defined(PROFILE)
+        profileReset();
+    #endif
 
     const auto [bestMove, score] = searcher.search(maxDepth, maxNodes, startTime, hardMs, softMs, true);
 
     std::cout << "bestmove " << bestMove.toUci() << std::endl;
+
+    // Time from main thread's decision to stop searching until bestmove is flushed
+    // Sampled right after the flush, before any reporting below
+    // Useful for tuning Move Overhead
+    const auto latency = std::chrono::steady_clock::now() - searcher.stopTime();
+
+    #if defined(PROFILE)
+        profilePrint(searcher.totalNodes());
+    #endif
+
+    if (reportLatency)
+    {
+        std::cout << "info string bestmove latency "
+                  << latency / std::chrono::microseconds(1) << " us"
+                  << std::endl;
+    }
 }
 
 } // namespace uci
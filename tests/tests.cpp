@@ -165,6 +165,50 @@ int main()
     assert(!board.isPseudolegalLegal(illegal));
     assert(board.isPseudolegalLegal(legal));
 
+    // isValidFen()
+    assert(isValidFen(START_FEN) && isValidFen(POSITION2_KIWIPETE) && isValidFen(POSITION4_MIRRORED));
+    assert(!isValidFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq")); // missing ep field
+    assert(!isValidFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQQBNR w KQkq - 0 1")); // no white king
+    assert(!isValidFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBN1 w KQkq - 0 1")); // K without rook
+    assert(!isValidFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq e6 0 1")); // ep without pawn
+    assert(!isValidFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 256 1"));
+
+    // pack() and Board(PackedBoard)
+    for (const std::string &fen : { START_FEN, POSITION4_MIRRORED,
+        std::string("1rq1kbnr/p2b2p1/1p2p2p/3p1pP1/1Q1pP3/1PP4P/P2B1P1R/RN2KBN1 w Qk f6 0 15") })
+    {
+        board = Board(fen);
+        const PackedBoard packed = board.pack(-123, WDL::WHITE_WIN);
+        const Board unpacked = Board(packed);
+
+        assert(unpacked.fen() == board.fen());
+        assert(unpacked.zobristHash() == board.zobristHash());
+        assert(unpacked.checkers() == board.checkers());
+        assert(packed.score == -123 && packed.wdl == WDL::WHITE_WIN);
+        assert(packed.isValid());
+    }
+
+    // PackedBoard::isValid()
+    {
+        const PackedBoard valid = Board(START_FEN).pack();
+
+        PackedBoard invalid = valid;
+        invalid.pieces[0] |= 0b0111; // a1 rook nibble -> out of range piece type
+        assert(!invalid.isValid());
+
+        invalid = valid;
+        invalid.pieces[0] = (invalid.pieces[0] & 0b0000'1111) | (6 << 4); // b1 knight -> castling rook
+        assert(!invalid.isValid());
+
+        invalid = valid;
+        invalid.pieces[2] = (invalid.pieces[2] & 0b1111'0000) | (u8)PieceType::QUEEN; // e1 king -> queen
+        assert(!invalid.isValid());
+
+        invalid = valid;
+        invalid.stmEpSquare = 20; // e3 en passant square with white to move
+        assert(!invalid.isValid());
+    }
+
     // Perft
 
     board = Board(START_FEN);
@@ -64,6 +64,21 @@ int main()
                       << std::endl;
     }
 
+    // Accumulators from finny table diffs must match full refreshes
+    FinnyTable* finnyTable = new FinnyTable();
+    nnue::resetFinnyTable(*finnyTable);
+
+    for (const auto& [fen, expectedEval] : FENS_EVAL)
+    {
+        const Board board = Board(fen);
+        const BothAccumulators bothAccs = BothAccumulators(board, *finnyTable);
+
+        if (!(bothAccs == BothAccumulators(board)))
+            std::cout << "Finny table accumulator differs from refresh in '" << fen << "'" << std::endl;
+    }
+
+    delete finnyTable;
+
     std::cout << "Finished" << std::endl;
     return 0;
 }